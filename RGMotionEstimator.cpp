@@ -0,0 +1,84 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+#include "RGMotionEstimator.h"
+
+void FRGMotionEstimator::Update(double Time, const FVector& Location, const FVector& NewVelocity, const FRotator& Rotation,
+	bool bVelocityKnown)
+{
+	if (bDiscontinuity && SampleCount > 0)
+	{
+		// Start over from here, keeping the estimates we had.
+		LastTime = Time;
+		LastLocation = Location;
+		LastYaw = Rotation.Yaw;
+		if (bVelocityKnown)
+		{
+			Velocity = NewVelocity;
+		}
+		bDiscontinuity = false;
+		return;
+	}
+
+	if (SampleCount == 0)
+	{
+		LastTime = Time;
+		LastLocation = Location;
+		LastYaw = Rotation.Yaw;
+		Velocity = NewVelocity;
+		Acceleration = FVector::ZeroVector;
+		YawRate = 0.f;
+		SampleCount = 1;
+		bDiscontinuity = false;
+		return;
+	}
+
+	const float DeltaSeconds = Time - LastTime;
+	if (DeltaSeconds <= UE_SMALL_NUMBER) return;
+
+	const float VelocityWeight = GetBlendWeight(DeltaSeconds, SmoothingTime);
+	const float AccelerationWeight = GetBlendWeight(DeltaSeconds, AccelerationSmoothingTime);
+
+	// Prefer the movement component's velocity when we have one, since it's exact (and zero really does mean
+	// stopped); fall back to the positional difference otherwise.
+	const FVector RawVelocity = bVelocityKnown ? NewVelocity : (Location - LastLocation) / DeltaSeconds;
+	const FVector SmoothedVelocity = FMath::Lerp(Velocity, RawVelocity, VelocityWeight);
+
+	const FVector RawAcceleration = (SmoothedVelocity - Velocity) / DeltaSeconds;
+	Acceleration = FMath::Lerp(Acceleration, RawAcceleration, AccelerationWeight);
+	Velocity = SmoothedVelocity;
+
+	const float RawYawRate = FRotator::NormalizeAxis(Rotation.Yaw - LastYaw) / DeltaSeconds;
+	YawRate = FMath::Lerp(YawRate, RawYawRate, VelocityWeight);
+
+	LastTime = Time;
+	LastLocation = Location;
+	LastYaw = Rotation.Yaw;
+	SampleCount++;
+}
+
+void FRGMotionEstimator::Reset()
+{
+	LastTime = 0.0;
+	LastLocation = Velocity = Acceleration = FVector::ZeroVector;
+	LastYaw = YawRate = 0.f;
+	SampleCount = 0;
+	bDiscontinuity = false;
+}
+
+void FRGMotionEstimator::TransformBy(const FTransform& Transform)
+{
+	LastLocation = Transform.TransformPosition(LastLocation);
+	LastYaw = FRotator::NormalizeAxis(LastYaw + Transform.Rotator().Yaw);
+	Velocity = Transform.TransformVectorNoScale(Velocity);
+	Acceleration = Transform.TransformVectorNoScale(Acceleration);
+}
@@ -0,0 +1,74 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/// A running estimate of velocity, acceleration and turn rate, updated once per movement sample.
+///
+/// Each update takes a finite difference against the previous sample and blends it into the running value
+/// with an exponential moving average. The blend weight is derived from the time between samples, so the
+/// amount of smoothing is the same regardless of frame rate.
+struct ROOICORE_API FRGMotionEstimator
+{
+	/// Feed a new sample in. Samples with a timestamp at or before the previous one are ignored. If the velocity
+	/// isn't known, it's worked out from the change in location instead.
+	void Update(double Time, const FVector& Location, const FVector& Velocity, const FRotator& Rotation, bool bVelocityKnown);
+
+	void Reset();
+
+	/// Marks a break in movement, such as a teleport: the next sample becomes the new starting point, without
+	/// being differenced against the last one, so that the jump doesn't show up as velocity or turn rate.
+	void MarkDiscontinuity() { bDiscontinuity = true; }
+
+	/// Moves the estimate into a different time base, such as when handing it between clocks.
+	void ShiftTime(double DeltaSeconds) { LastTime += DeltaSeconds; }
+
+	/// Moves the estimate rigidly into a different space.
+	void TransformBy(const FTransform& Transform);
+
+	/// True once we've seen enough samples to have an acceleration estimate.
+	bool IsValid() const { return SampleCount > 1; }
+
+	FVector GetVelocity() const { return Velocity; }
+	FVector GetAcceleration() const { return Acceleration; }
+
+	/// Turn rate, in degrees per second.
+	float GetYawRate() const { return YawRate; }
+
+	FRotator GetRotationVelocity() const { return FRotator(0.f, YawRate, 0.f); }
+
+	/// Time constant, in seconds, for the velocity and turn rate averages.
+	float SmoothingTime { 0.05f };
+
+	/// Time constant, in seconds, for the acceleration average. Acceleration is a second difference and
+	/// noisier than velocity, so it wants a little more smoothing.
+	float AccelerationSmoothingTime { 0.1f };
+
+private:
+
+	static float GetBlendWeight(float DeltaSeconds, float TimeConstant)
+	{
+		return TimeConstant > 0.f ? 1.f - FMath::Exp(-DeltaSeconds / TimeConstant) : 1.f;
+	}
+
+	double LastTime { 0.0 };
+	FVector LastLocation { 0.f };
+	float LastYaw { 0.f };
+	int32 SampleCount { 0 };
+	bool bDiscontinuity { false };
+
+	FVector Velocity { 0.f };
+	FVector Acceleration { 0.f };
+	float YawRate { 0.f };
+};
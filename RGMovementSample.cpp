@@ -11,6 +11,8 @@
  */
 
 #include "RGMovementSample.h"
+#include "Components/LineBatchComponent.h"
+#include "Engine/World.h"
 
 void FRGMovementSample::DrawDebug(const UWorld* World, const FTransform& FromOrigin, const FColor& Color) const
 {
@@ -21,19 +23,155 @@ void FRGMovementSample::DrawDebug(const UWorld* World, const FTransform& FromOri
 	DrawDebugDirectionalArrow(World, PositionWS, WorldVelocity, 20.f, Color, false, -1, 0, 2.f);	
 }
 
+FRGMovementSample FRGMovementSample::Interpolate(const FRGMovementSample& From, const FRGMovementSample& To, float AtSeconds)
+{
+	const float Span = To.AccumulatedSeconds - From.AccumulatedSeconds;
+	const float Alpha = Span > UE_SMALL_NUMBER ? FMath::Clamp((AtSeconds - From.AccumulatedSeconds) / Span, 0.f, 1.f) : 1.f;
+
+	FRGMovementSample Result;
+	Result.AccumulatedSeconds = AtSeconds;
+	Result.RelativeTransform.Blend(From.RelativeTransform, To.RelativeTransform, Alpha);
+	Result.RelativeLinearVelocity = FMath::Lerp(From.RelativeLinearVelocity, To.RelativeLinearVelocity, Alpha);
+	Result.WorldTransform.Blend(From.WorldTransform, To.WorldTransform, Alpha);
+	Result.WorldLinearVelocity = FMath::Lerp(From.WorldLinearVelocity, To.WorldLinearVelocity, Alpha);
+	Result.ActorWorldRotation = FQuat::Slerp(From.ActorWorldRotation.Quaternion(), To.ActorWorldRotation.Quaternion(), Alpha).Rotator();
+	Result.ActorDeltaRotation = To.ActorDeltaRotation;
+	return Result;
+}
+
 void FRGMovementSampleCollection::DrawDebug(const UWorld* World, const FTransform& FromOrigin, const FColor& PastColor,
                                             const FColor& FutureColor) const
 {
-	FLinearColor PastColorLinear = PastColor.ReinterpretAsLinear();
-	FLinearColor FutureColorLinear = FutureColor.ReinterpretAsLinear();
+	if (!IsValid(World) || !World->LineBatcher) return;
+
+	TArray<FBatchedLine> Lines;
+	AppendDebugLines(Lines, FromOrigin, 1, PastColor, FutureColor);
+	World->LineBatcher->DrawLines(Lines);
+}
 
+void FRGMovementSampleCollection::AppendDebugLines(TArray<FBatchedLine>& OutLines, const FTransform& FromOrigin,
+	int32 SampleStride, const FColor& PastColor, const FColor& FutureColor) const
+{
 	const int32 TotalCount = Samples.Num();
-	
-	for (int32 Idx = 0; Idx < TotalCount; Idx++)
+	if (TotalCount == 0) return;
+
+	SampleStride = FMath::Max(SampleStride, 1);
+	OutLines.Reserve(OutLines.Num() + 2 * (TotalCount / SampleStride + 1));
+
+	// A straight linear blend is plenty for a debug gradient, and far cheaper than going through HSV.
+	const FLinearColor PastColorLinear(PastColor);
+	const FLinearColor FutureColorLinear(FutureColor);
+
+	FVector PreviousPositionWS = FVector::ZeroVector;
+	for (int32 Idx = 0; Idx < TotalCount; Idx += SampleStride)
 	{
+		const FRGMovementSample& Sample = Samples[Idx];
 		const float LerpPoint = static_cast<float>(Idx) / static_cast<float>(TotalCount);
-		const FLinearColor TimelineColor = FLinearColor::LerpUsingHSV(PastColor, FutureColor, LerpPoint);
-		
-		Samples[Idx].DrawDebug(World, FromOrigin, TimelineColor.ToFColor(true));	
+		const FLinearColor TimelineColor = FMath::Lerp(PastColorLinear, FutureColorLinear, LerpPoint);
+
+		const FVector PositionWS = FromOrigin.TransformPosition(Sample.RelativeTransform.GetTranslation());
+		const FVector VelocityWS = FromOrigin.TransformVector(Sample.RelativeLinearVelocity) * 0.025f + PositionWS;
+
+		if (Idx > 0)
+		{
+			OutLines.Emplace(PreviousPositionWS, PositionWS, TimelineColor, 0.f, 1.f, SDPG_World);
+		}
+		OutLines.Emplace(PositionWS, VelocityWS, TimelineColor, 0.f, 2.f, SDPG_World);
+
+		PreviousPositionWS = PositionWS;
+	}
+}
+
+bool FRGMovementSampleCollection::SampleAtTime(float Seconds, FRGMovementSample& OutSample) const
+{
+	const int32 Count = Samples.Num();
+	if (Count == 0) return false;
+
+	if (Seconds <= Samples[0].AccumulatedSeconds)
+	{
+		OutSample = Samples[0];
+		return true;
+	}
+
+	if (Seconds >= Samples.Last().AccumulatedSeconds)
+	{
+		OutSample = Samples.Last();
+		return true;
+	}
+
+	// Find the last sample at or before the requested time.
+	int32 Low = 0;
+	int32 High = Count - 1;
+	while (High - Low > 1)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if (Samples[Mid].AccumulatedSeconds <= Seconds)
+		{
+			Low = Mid;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	OutSample = FRGMovementSample::Interpolate(Samples[Low], Samples[High], Seconds);
+	return true;
+}
+
+void FRGMovementSampleCollection::Simplify(float PositionTolerance, float RotationTolerance, float SpeedTolerance, int32 MaxWindow)
+{
+	if (Samples.Num() < 3) return;
+
+	const float PositionToleranceSquared = FMath::Square(PositionTolerance);
+	const float RotationToleranceRadians = FMath::DegreesToRadians(RotationTolerance);
+	const float SpeedToleranceSquared = FMath::Square(SpeedTolerance);
+	MaxWindow = FMath::Max(MaxWindow, 1);
+
+	const auto MustKeep = [](const FRGMovementSample& Sample)
+	{
+		return Sample.bUseAsMarker || Sample.AccumulatedSeconds == 0.f;
+	};
+
+	// Would a segment from Samples[From] to Samples[To] reproduce everything in between?
+	const auto IsWithinTolerance = [&](int32 From, int32 To)
+	{
+		for (int32 Idx = From + 1; Idx < To; Idx++)
+		{
+			const FRGMovementSample& Point = Samples[Idx];
+			const FRGMovementSample Interpolated = FRGMovementSample::Interpolate(Samples[From], Samples[To], Point.AccumulatedSeconds);
+			if (FVector::DistSquared(Interpolated.WorldTransform.GetLocation(), Point.WorldTransform.GetLocation()) > PositionToleranceSquared ||
+				Interpolated.WorldTransform.GetRotation().AngularDistance(Point.WorldTransform.GetRotation()) > RotationToleranceRadians ||
+				FVector::DistSquared(Interpolated.WorldLinearVelocity, Point.WorldLinearVelocity) > SpeedToleranceSquared)
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	// Open a segment at the last kept sample and stretch it for as long as it stays within tolerance; this is
+	// the same streaming simplification the long history uses, compacting in place as it goes.
+	int32 Kept = 0;
+	const auto Keep = [&](int32 Idx)
+	{
+		// Assignment doesn't carry the marker flag over, so copy it by hand.
+		const bool bMarker = Samples[Idx].bUseAsMarker;
+		Samples[++Kept] = Samples[Idx];
+		Samples[Kept].bUseAsMarker = bMarker;
+	};
+
+	int32 Anchor = 0;
+	for (int32 Idx = 2; Idx < Samples.Num(); Idx++)
+	{
+		const int32 Candidate = Idx - 1;
+		if (MustKeep(Samples[Candidate]) || Idx - Anchor > MaxWindow || !IsWithinTolerance(Anchor, Idx))
+		{
+			Keep(Candidate);
+			Anchor = Candidate;
+		}
 	}
+
+	Keep(Samples.Num() - 1);
+	Samples.SetNum(Kept + 1, false);
 }
@@ -16,6 +16,8 @@
 #include "Animation/MotionTrajectoryTypes.h"
 #include "RGMovementSample.generated.h"
 
+struct FBatchedLine;
+
 USTRUCT(BlueprintType)
 struct ROOICORE_API FRGMovementSample
 {
@@ -78,8 +80,8 @@ struct ROOICORE_API FRGMovementSample
 
 		const float TimeRatio = 1.f / ( AccumulatedSeconds - OtherSample.AccumulatedSeconds );
 
-		const FVector Travel = WorldTransform.GetLocation() - OtherSample.WorldTransform.GetLocation();
-		return Travel / TimeRatio;		
+		const FVector DeltaVelocity = WorldLinearVelocity - OtherSample.WorldLinearVelocity;
+		return DeltaVelocity * TimeRatio;		
 	}
 
 	bool IsZeroSample() const
@@ -147,6 +149,9 @@ struct ROOICORE_API FRGMovementSample
 	}
 
 	void DrawDebug(const UWorld* World, const FTransform& FromOrigin = FTransform::Identity, const FColor& Color = FColor::Purple) const;
+
+	/// Interpolates between two samples at the given time, which should lie between theirs.
+	static FRGMovementSample Interpolate(const FRGMovementSample& From, const FRGMovementSample& To, float AtSeconds);
 	
 	explicit operator FTrajectorySample() const
 	{
@@ -171,6 +176,21 @@ struct ROOICORE_API FRGMovementSampleCollection
 
 	void DrawDebug(const UWorld* World, const FTransform& FromOrigin, const FColor& PastColor = FColor::Blue,
 		const FColor& FutureColor = FColor::Red) const;
+
+	/// Appends this collection as a path plus per-sample velocity lines to a batch, for submitting to a line
+	/// batcher in one go. Only every SampleStride'th sample is included.
+	void AppendDebugLines(TArray<FBatchedLine>& OutLines, const FTransform& FromOrigin, int32 SampleStride = 1,
+		const FColor& PastColor = FColor::Blue, const FColor& FutureColor = FColor::Red) const;
+
+	/// Interpolates the collection at the given time, clamped to the span it covers. The samples must be in time
+	/// order, but needn't be evenly spaced. Returns false if empty.
+	bool SampleAtTime(float Seconds, FRGMovementSample& OutSample) const;
+
+	/// Drops every sample which interpolating between its neighbours reproduces to within the given tolerances
+	/// (in units, degrees, and units per second). SampleAtTime on the result stays within those tolerances of
+	/// the original samples. Each kept sample replaces at most MaxWindow others, which bounds the cost; markers
+	/// and the present-moment sample are always kept.
+	void Simplify(float PositionTolerance, float RotationTolerance, float SpeedTolerance, int32 MaxWindow = 32);
 	
 	explicit operator FTrajectorySampleRange() const
 	{
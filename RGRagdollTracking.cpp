@@ -0,0 +1,29 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+#include "RGRagdollTracking.h"
+#include "PhysicsProxy/SingleParticlePhysicsProxy.h"
+
+void FRGRagdollTrackingCallback::OnPreSimulate_Internal()
+{
+	const FRGRagdollTrackingInput* Input = GetConsumerInput_Internal();
+	if (Input == nullptr || Input->PelvisProxy == nullptr) return;
+
+	const Chaos::FRigidBodyHandle_Internal* Handle = Input->PelvisProxy->GetPhysicsThreadAPI();
+	if (Handle == nullptr) return;
+
+	FRGRagdollTrackingOutput& Output = GetProducerOutputData_Internal();
+	Output.bValid = true;
+	Output.Location = Handle->X();
+	Output.Rotation = Handle->R();
+	Output.LinearVelocity = Handle->V();
+}
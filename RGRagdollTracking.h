@@ -0,0 +1,56 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/SimCallbackInput.h"
+#include "Chaos/SimCallbackObject.h"
+
+namespace Chaos
+{
+	class FSingleParticlePhysicsProxy;
+}
+
+/// Game thread to physics thread: which body to track this step.
+struct ROOICORE_API FRGRagdollTrackingInput : public Chaos::FSimCallbackInput
+{
+	Chaos::FSingleParticlePhysicsProxy* PelvisProxy { nullptr };
+
+	void Reset()
+	{
+		PelvisProxy = nullptr;
+	}
+};
+
+/// Physics thread to game thread: the tracked body's state at the start of a step.
+struct ROOICORE_API FRGRagdollTrackingOutput : public Chaos::FSimCallbackOutput
+{
+	bool bValid { false };
+	FVector Location { 0.f };
+	FQuat Rotation { FQuat::Identity };
+	FVector LinearVelocity { 0.f };
+
+	void Reset()
+	{
+		bValid = false;
+		Location = LinearVelocity = FVector::ZeroVector;
+		Rotation = FQuat::Identity;
+	}
+};
+
+/// Reads the ragdoll's pelvis state on the physics thread each step and publishes it back to the game thread,
+/// so that following a ragdoll never needs a synchronous bone query.
+class ROOICORE_API FRGRagdollTrackingCallback : public Chaos::TSimCallbackObject<FRGRagdollTrackingInput, FRGRagdollTrackingOutput>
+{
+	virtual void OnPreSimulate_Internal() override;
+};
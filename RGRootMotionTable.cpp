@@ -0,0 +1,84 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+#include "RGRootMotionTable.h"
+#include "Animation/AnimMontage.h"
+
+void FRGRootMotionTable::Bake(const UAnimMontage* Montage, float InSampleRate)
+{
+	Translations.Reset();
+	Yaws.Reset();
+	Duration = 0.f;
+
+	if (Montage == nullptr || !Montage->HasRootMotion() || InSampleRate <= 0.f) return;
+
+	Duration = Montage->GetPlayLength();
+	if (Duration <= UE_SMALL_NUMBER) return;
+
+	// Round the rate up so that the samples evenly divide the montage, and the last one lands on its end.
+	const int32 NumSamples = FMath::CeilToInt32(Duration * InSampleRate) + 1;
+	SampleRate = (NumSamples - 1) / Duration;
+
+	Translations.Reserve(NumSamples);
+	Yaws.Reserve(NumSamples);
+
+	// Accumulate one step at a time, so that baking is linear in the length of the montage rather than
+	// re-extracting everything from the start for every sample.
+	FTransform Accumulated = FTransform::Identity;
+	float PreviousPosition = 0.f;
+	float Yaw = 0.f;
+	float PreviousWrappedYaw = 0.f;
+
+	for (int32 Idx = 0; Idx < NumSamples; Idx++)
+	{
+		const float Position = Idx == NumSamples - 1 ? Duration : Idx / SampleRate;
+		if (Position > PreviousPosition)
+		{
+			Accumulated = Montage->ExtractRootMotionFromTrackRange(PreviousPosition, Position) * Accumulated;
+			PreviousPosition = Position;
+		}
+
+		const float WrappedYaw = Accumulated.GetRotation().Rotator().Yaw;
+		Yaw += FRotator::NormalizeAxis(WrappedYaw - PreviousWrappedYaw);
+		PreviousWrappedYaw = WrappedYaw;
+
+		Translations.Add(FVector3f(Accumulated.GetTranslation()));
+		Yaws.Add(Yaw);
+	}
+}
+
+void FRGRootMotionTable::Evaluate(float Position, FVector& OutTranslation, float& OutYaw) const
+{
+	if (IsEmpty())
+	{
+		OutTranslation = FVector::ZeroVector;
+		OutYaw = 0.f;
+		return;
+	}
+
+	const float Sample = FMath::Clamp(Position, 0.f, Duration) * SampleRate;
+	const int32 Idx = FMath::Min(FMath::FloorToInt32(Sample), Translations.Num() - 1);
+	const int32 NextIdx = FMath::Min(Idx + 1, Translations.Num() - 1);
+	const float Alpha = FMath::Clamp(Sample - Idx, 0.f, 1.f);
+
+	OutTranslation = FVector(FMath::Lerp(Translations[Idx], Translations[NextIdx], Alpha));
+	OutYaw = FMath::Lerp(Yaws[Idx], Yaws[NextIdx], Alpha);
+}
+
+FVector FRGRootMotionTable::EvaluateVelocity(float Position) const
+{
+	if (Translations.Num() < 2 || Position < 0.f || Position >= Duration) return FVector::ZeroVector;
+
+	const int32 Idx = FMath::Min(FMath::FloorToInt32(Position * SampleRate), Translations.Num() - 2);
+	return FVector(Translations[Idx + 1] - Translations[Idx]) * SampleRate;
+}
@@ -0,0 +1,55 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UAnimMontage;
+
+/// A montage's root motion, baked into a table of cumulative root translation and yaw at a fixed sample rate,
+/// so that prediction can look it up in constant time rather than evaluating the animation every frame.
+///
+/// Translation and yaw are in mesh component space, relative to the start of the montage. Yaw is unwound as it's
+/// baked, so it keeps accumulating past a full turn rather than wrapping.
+struct ROOICORE_API FRGRootMotionTable
+{
+	/// Extracts the montage's root motion at (at least) the given number of samples per second, discarding the
+	/// current contents. The montage's own track positions are used, so play rate is applied when the table is read.
+	void Bake(const UAnimMontage* Montage, float InSampleRate);
+
+	bool IsEmpty() const { return Translations.IsEmpty(); }
+
+	/// Length of the baked montage, in track position seconds.
+	float GetDuration() const { return Duration; }
+
+	/// Cumulative root motion at the given track position, clamped to the montage. Constant time.
+	void Evaluate(float Position, FVector& OutTranslation, float& OutYaw) const;
+
+	/// Root velocity at the given track position, in units per track second, relative to the start of the
+	/// montage. Constant time.
+	FVector EvaluateVelocity(float Position) const;
+
+	/// Approximate memory used by the table, for stats.
+	SIZE_T GetAllocatedSize() const { return Translations.GetAllocatedSize() + Yaws.GetAllocatedSize(); }
+
+private:
+
+	float SampleRate { 30.f };
+	float Duration { 0.f };
+
+	/// One entry per sample, plus one at the very end of the montage. Single precision keeps the table compact;
+	/// root motion is relative, so it never reaches magnitudes where that matters.
+	TArray<FVector3f> Translations;
+	TArray<float> Yaws;
+};
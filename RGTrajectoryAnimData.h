@@ -0,0 +1,105 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RGTrajectoryAnimData.generated.h"
+
+/// A trajectory sample pared down to what animation needs, relative to the actor.
+USTRUCT(BlueprintType)
+struct ROOICORE_API FRGTrajectoryAnimSample
+{
+	GENERATED_BODY()
+
+	/// Seconds from now; negative for history, positive for prediction.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float Seconds { 0.f };
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FVector Position { 0.f };
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float Yaw { 0.f };
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FVector Velocity { 0.f };
+};
+
+/// Everything an animation graph typically wants from the trajectory component, filled in once per trajectory
+/// tick. Anim instances (or their proxies) can copy it out or bind to it directly with property access, rather
+/// than calling back into the component from the animation worker threads.
+USTRUCT(BlueprintType)
+struct ROOICORE_API FRGTrajectoryAnimData
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bIsStopping { false };
+
+	/// Relative to the actor.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FVector StopPoint { 0.f };
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bIsPivoting { false };
+
+	/// Relative to the actor.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FVector PivotPoint { 0.f };
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bIsLanding { false };
+
+	/// Relative to the actor.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FVector LandingPoint { 0.f };
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float LandingSeconds { 0.f };
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bInputPresent { false };
+
+	/// The angle, in degrees, by which velocity differs from input on the XY plane.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float InputVelocityOffset { 0.f };
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FVector EffectiveAcceleration { 0.f };
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FVector LinearVelocity { 0.f };
+
+	/// History followed by prediction, oldest first.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TArray<FRGTrajectoryAnimSample> Samples;
+
+	/// Index of the present-moment sample within Samples; everything before it is history.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 PresentIndex { INDEX_NONE };
+
+	/// True for the first update after the history was re-anchored by a teleport or correction; anything
+	/// accumulated along the old trajectory (distance matching, for instance) should be reset.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bHistoryDiscontinuity { false };
+
+	TConstArrayView<FRGTrajectoryAnimSample> GetHistory() const
+	{
+		return Samples.IsValidIndex(PresentIndex) ? MakeArrayView(Samples.GetData(), PresentIndex) : TConstArrayView<FRGTrajectoryAnimSample>();
+	}
+
+	TConstArrayView<FRGTrajectoryAnimSample> GetPrediction() const
+	{
+		return Samples.IsValidIndex(PresentIndex) ? MakeArrayView(Samples.GetData() + PresentIndex + 1, Samples.Num() - PresentIndex - 1) : TConstArrayView<FRGTrajectoryAnimSample>();
+	}
+};
@@ -0,0 +1,221 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+#include "RGTrajectoryAvoidance.h"
+#include "Async/ParallelFor.h"
+
+int32 FRGTrajectoryAvoidanceBatch::AddTrajectory(TConstArrayView<FRGMovementSample> Samples, float Radius, float HalfHeight)
+{
+	if (Trajectories.IsEmpty())
+	{
+		for (const FRGMovementSample& Sample : Samples)
+		{
+			if (Sample.AccumulatedSeconds < 0.f) continue;
+			Origin = Sample.WorldTransform.GetLocation();
+			break;
+		}
+	}
+
+	FTrajectory& Trajectory = Trajectories.AddDefaulted_GetRef();
+	Trajectory.Offset = Time.Num();
+	Trajectory.Radius = Radius;
+	Trajectory.HalfHeight = HalfHeight;
+
+	for (const FRGMovementSample& Sample : Samples)
+	{
+		if (Sample.AccumulatedSeconds < 0.f) continue;
+
+		const FVector Location = Sample.WorldTransform.GetLocation() - Origin;
+		X.Add(Location.X);
+		Y.Add(Location.Y);
+		Z.Add(Location.Z);
+		Time.Add(Sample.AccumulatedSeconds);
+	}
+	Trajectory.Count = Time.Num() - Trajectory.Offset;
+
+	return Trajectories.Num() - 1;
+}
+
+void FRGTrajectoryAvoidanceBatch::Reset()
+{
+	Trajectories.Reset();
+	X.Reset();
+	Y.Reset();
+	Z.Reset();
+	Time.Reset();
+}
+
+void FRGTrajectoryAvoidanceBatch::TestPairs(TConstArrayView<FIntPoint> Pairs, TArray<FRGTrajectoryContact>& OutContacts,
+	bool bForceSingleThread) const
+{
+	OutContacts.SetNum(Pairs.Num(), false);
+
+	const int32 NumTasks = FMath::DivideAndRoundUp(Pairs.Num(), PairsPerTask);
+	ParallelFor(NumTasks, [&](int32 Task)
+	{
+		FScratch Scratch;
+		const int32 End = FMath::Min((Task + 1) * PairsPerTask, Pairs.Num());
+		for (int32 Idx = Task * PairsPerTask; Idx < End; Idx++)
+		{
+			OutContacts[Idx] = TestPair(Pairs[Idx].X, Pairs[Idx].Y, Scratch);
+		}
+	}, bForceSingleThread || NumTasks <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+FRGTrajectoryContact FRGTrajectoryAvoidanceBatch::TestPair(int32 First, int32 Second) const
+{
+	FScratch Scratch;
+	return TestPair(First, Second, Scratch);
+}
+
+FRGTrajectoryContact FRGTrajectoryAvoidanceBatch::TestPair(int32 First, int32 Second, FScratch& Scratch) const
+{
+	FRGTrajectoryContact Result;
+	Result.First = First;
+	Result.Second = Second;
+
+	if (!Trajectories.IsValidIndex(First) || !Trajectories.IsValidIndex(Second)) return Result;
+
+	const FTrajectory& A = Trajectories[First];
+	const FTrajectory& B = Trajectories[Second];
+	if (A.Count == 0 || B.Count == 0) return Result;
+
+	// Only the span both trajectories cover can be compared.
+	const float StartTime = FMath::Max(Time[A.Offset], Time[B.Offset]);
+	const float EndTime = FMath::Min(Time[A.Offset + A.Count - 1], Time[B.Offset + B.Count - 1]);
+	if (StartTime > EndTime) return Result;
+
+	int32 FirstA = A.Offset;
+	while (FirstA < A.Offset + A.Count - 1 && Time[FirstA] < StartTime)
+	{
+		FirstA++;
+	}
+	int32 EndA = FirstA;
+	while (EndA < A.Offset + A.Count && Time[EndA] <= EndTime)
+	{
+		EndA++;
+	}
+	const int32 Count = EndA - FirstA;
+	if (Count == 0) return Result;
+
+	Scratch.DX.SetNumUninitialized(Count, false);
+	Scratch.DY.SetNumUninitialized(Count, false);
+	Scratch.DZ.SetNumUninitialized(Count, false);
+	Scratch.Time.SetNumUninitialized(Count, false);
+
+	// Resample the second trajectory at the first's sample times.
+	int32 IdxB = B.Offset;
+	const int32 LastB = B.Offset + B.Count - 1;
+	for (int32 Idx = 0; Idx < Count; Idx++)
+	{
+		const float SampleTime = Time[FirstA + Idx];
+		while (IdxB < LastB && Time[IdxB + 1] < SampleTime)
+		{
+			IdxB++;
+		}
+
+		const int32 NextB = FMath::Min(IdxB + 1, LastB);
+		const float Span = Time[NextB] - Time[IdxB];
+		const float Alpha = Span > UE_SMALL_NUMBER ? FMath::Clamp((SampleTime - Time[IdxB]) / Span, 0.f, 1.f) : 0.f;
+
+		Scratch.DX[Idx] = FMath::Lerp(X[IdxB], X[NextB], Alpha);
+		Scratch.DY[Idx] = FMath::Lerp(Y[IdxB], Y[NextB], Alpha);
+		Scratch.DZ[Idx] = FMath::Lerp(Z[IdxB], Z[NextB], Alpha);
+		Scratch.Time[Idx] = SampleTime;
+	}
+
+	// Separation from the first trajectory to the second at every sample. A straight loop over contiguous
+	// floats, which the compiler can vectorize.
+	float* RESTRICT DX = Scratch.DX.GetData();
+	float* RESTRICT DY = Scratch.DY.GetData();
+	float* RESTRICT DZ = Scratch.DZ.GetData();
+	const float* RESTRICT AX = X.GetData() + FirstA;
+	const float* RESTRICT AY = Y.GetData() + FirstA;
+	const float* RESTRICT AZ = Z.GetData() + FirstA;
+	for (int32 Idx = 0; Idx < Count; Idx++)
+	{
+		DX[Idx] -= AX[Idx];
+		DY[Idx] -= AY[Idx];
+		DZ[Idx] -= AZ[Idx];
+	}
+
+	const float ContactRadius = A.Radius + B.Radius;
+	const float ContactRadiusSquared = FMath::Square(ContactRadius);
+	const float ContactHeight = A.HalfHeight + B.HalfHeight;
+
+	float ClosestDistanceSquared = FMath::Square(DX[0]) + FMath::Square(DY[0]);
+	float ClosestSeconds = Scratch.Time[0];
+
+	auto RecordContact = [&](int32 Idx, int32 NextIdx, float Alpha)
+	{
+		const float SeparationZ = FMath::Lerp(DZ[Idx], DZ[NextIdx], Alpha);
+		if (Result.bWillContact || FMath::Abs(SeparationZ) > ContactHeight) return;
+
+		const FVector2D Separation(FMath::Lerp(DX[Idx], DX[NextIdx], Alpha), FMath::Lerp(DY[Idx], DY[NextIdx], Alpha));
+		const FVector2D Normal = Separation.GetSafeNormal();
+		const FVector Center(
+			FMath::Lerp(AX[Idx], AX[NextIdx], Alpha),
+			FMath::Lerp(AY[Idx], AY[NextIdx], Alpha),
+			FMath::Lerp(AZ[Idx], AZ[NextIdx], Alpha));
+
+		Result.bWillContact = true;
+		Result.ContactSeconds = FMath::Lerp(Scratch.Time[Idx], Scratch.Time[NextIdx], Alpha);
+		Result.ContactLocation = Origin + Center + FVector(Normal * A.Radius, 0.f);
+	};
+
+	if (ClosestDistanceSquared <= ContactRadiusSquared)
+	{
+		RecordContact(0, 0, 0.f);
+	}
+
+	for (int32 Idx = 0; Idx + 1 < Count; Idx++)
+	{
+		// Separation moves linearly across the segment: D(u) = D0 + Delta * u.
+		const float DeltaX = DX[Idx + 1] - DX[Idx];
+		const float DeltaY = DY[Idx + 1] - DY[Idx];
+		const float QuadA = DeltaX * DeltaX + DeltaY * DeltaY;
+		const float QuadB = DX[Idx] * DeltaX + DY[Idx] * DeltaY;
+		const float QuadC = DX[Idx] * DX[Idx] + DY[Idx] * DY[Idx] - ContactRadiusSquared;
+
+		if (QuadC <= 0.f)
+		{
+			// Already overlapping on the XY plane at the start of the segment.
+			RecordContact(Idx, Idx + 1, 0.f);
+		}
+
+		if (QuadA <= UE_SMALL_NUMBER) continue;
+
+		const float ClosestAlpha = FMath::Clamp(-QuadB / QuadA, 0.f, 1.f);
+		const float DistanceSquared = QuadA * ClosestAlpha * ClosestAlpha + 2.f * QuadB * ClosestAlpha + QuadC + ContactRadiusSquared;
+		if (DistanceSquared < ClosestDistanceSquared)
+		{
+			ClosestDistanceSquared = DistanceSquared;
+			ClosestSeconds = FMath::Lerp(Scratch.Time[Idx], Scratch.Time[Idx + 1], ClosestAlpha);
+		}
+
+		// Earliest root of |D(u)|^2 = R^2, if the capsules are closing on each other.
+		const float Discriminant = QuadB * QuadB - QuadA * QuadC;
+		if (!Result.bWillContact && QuadB < 0.f && Discriminant >= 0.f)
+		{
+			const float ContactAlpha = (-QuadB - FMath::Sqrt(Discriminant)) / QuadA;
+			if (ContactAlpha >= 0.f && ContactAlpha <= 1.f)
+			{
+				RecordContact(Idx, Idx + 1, ContactAlpha);
+			}
+		}
+	}
+
+	Result.ClosestSeconds = ClosestSeconds;
+	Result.ClosestDistance = FMath::Sqrt(FMath::Max(ClosestDistanceSquared, 0.f));
+	return Result;
+}
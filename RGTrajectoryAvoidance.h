@@ -0,0 +1,99 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RGMovementSample.h"
+
+/// When, and where, two predicted trajectories first bring their capsules into contact.
+struct ROOICORE_API FRGTrajectoryContact
+{
+	/// Indices of the two trajectories, as returned by FRGTrajectoryAvoidanceBatch::AddTrajectory.
+	int32 First { INDEX_NONE };
+	int32 Second { INDEX_NONE };
+
+	bool bWillContact { false };
+
+	/// Seconds from now until the capsules first touch, if they will.
+	float ContactSeconds { 0.f };
+
+	/// Where they touch: on the surface of the first capsule, facing the second.
+	FVector ContactLocation { 0.f };
+
+	/// Seconds from now until the capsule centers are closest on the XY plane, and how far apart they are then.
+	float ClosestSeconds { 0.f };
+	float ClosestDistance { 0.f };
+};
+
+/// Tests predicted trajectories against each other as swept upright capsules, for local avoidance. Add each
+/// pawn's predicted trajectory once, then test whichever pairs the broadphase (or the caller) came up with;
+/// the pairs are spread across worker threads.
+///
+/// Trajectories are stored structure-of-arrays. For each pair, the second trajectory is resampled onto the
+/// first's sample times, and the separation is worked out for every sample in one straight loop before the
+/// per-segment contact tests.
+class ROOICORE_API FRGTrajectoryAvoidanceBatch
+{
+public:
+
+	/// Adds a trajectory, such as the output of PredictMovementFuture. Only samples at or after the present
+	/// moment are used. Returns its index, for building pairs.
+	int32 AddTrajectory(TConstArrayView<FRGMovementSample> Samples, float Radius, float HalfHeight);
+
+	int32 Num() const { return Trajectories.Num(); }
+
+	/// Clears the trajectories, keeping their storage.
+	void Reset();
+
+	/// Tests each pair of trajectories, filling in one contact per pair in the same order.
+	void TestPairs(TConstArrayView<FIntPoint> Pairs, TArray<FRGTrajectoryContact>& OutContacts, bool bForceSingleThread = false) const;
+
+	/// Tests a single pair.
+	FRGTrajectoryContact TestPair(int32 First, int32 Second) const;
+
+	/// Pairs per worker task; below this many, TestPairs doesn't bother going wide.
+	static constexpr int32 PairsPerTask = 32;
+
+private:
+
+	struct FTrajectory
+	{
+		int32 Offset { 0 };
+		int32 Count { 0 };
+		float Radius { 0.f };
+		float HalfHeight { 0.f };
+	};
+
+	/// Per-pair working space, reused across the pairs in a task.
+	struct FScratch
+	{
+		TArray<float, TInlineAllocator<64>> DX;
+		TArray<float, TInlineAllocator<64>> DY;
+		TArray<float, TInlineAllocator<64>> DZ;
+		TArray<float, TInlineAllocator<64>> Time;
+	};
+
+	FRGTrajectoryContact TestPair(int32 First, int32 Second, FScratch& Scratch) const;
+
+	TArray<FTrajectory> Trajectories;
+
+	/// Positions are stored relative to this, taken from the first trajectory added, so that they keep their
+	/// precision as floats far from the world origin.
+	FVector Origin { 0.f };
+
+	TArray<float> X;
+	TArray<float> Y;
+	TArray<float> Z;
+	TArray<float> Time;
+};
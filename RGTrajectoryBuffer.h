@@ -0,0 +1,167 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/// A fixed-capacity ring buffer for trajectory data. Storage is a single heap allocation, made when the capacity
+/// is set. Once full, adding an element overwrites the oldest one, so steady-state use never allocates.
+///
+/// Slots are constructed up front and reused: popping an element doesn't destroy it, it's simply overwritten
+/// later. This is intended for plain data.
+///
+/// The buffer can also be pointed at externally owned storage, such as a slot in URGTrajectorySubsystem's
+/// shared arena, in which case it makes no allocations of its own at all.
+template <typename ElementType>
+class TRGTrajectoryBuffer
+{
+public:
+
+	/// Sets how many elements we hold before overwriting the oldest, and discards the current contents.
+	void SetCapacity(int32 NewCapacity)
+	{
+		check(NewCapacity > 0);
+
+		ExternalStorage = nullptr;
+		Storage.Reset();
+		Storage.SetNum(NewCapacity);
+		Capacity = NewCapacity;
+		Head = 0;
+		Count = 0;
+	}
+
+	/// Uses the given (already constructed) elements as our storage instead of our own, discarding the current
+	/// contents. The storage must stay valid until it's detached.
+	void AttachStorage(ElementType* InStorage, int32 InCapacity)
+	{
+		check(InStorage != nullptr && InCapacity > 0);
+
+		Storage.Empty();
+		ExternalStorage = InStorage;
+		Capacity = InCapacity;
+		Head = 0;
+		Count = 0;
+	}
+
+	/// Stops using external storage. The buffer is left empty, with the same capacity, and sets up storage of
+	/// its own the next time an element is added.
+	void DetachStorage()
+	{
+		if (ExternalStorage == nullptr) return;
+
+		ExternalStorage = nullptr;
+		Head = 0;
+		Count = 0;
+	}
+
+	bool HasExternalStorage() const { return ExternalStorage != nullptr; }
+
+	int32 GetCapacity() const { return Capacity; }
+	int32 Num() const { return Count; }
+	bool IsEmpty() const { return Count == 0; }
+	bool IsFull() const { return Count == Capacity; }
+
+	ElementType& operator[](int32 Index)
+	{
+		checkSlow(Index >= 0 && Index < Count);
+		return GetData()[WrapIndex(Head + Index)];
+	}
+
+	const ElementType& operator[](int32 Index) const
+	{
+		checkSlow(Index >= 0 && Index < Count);
+		return GetData()[WrapIndex(Head + Index)];
+	}
+
+	ElementType& First() { return (*this)[0]; }
+	const ElementType& First() const { return (*this)[0]; }
+	ElementType& Last() { return (*this)[Count - 1]; }
+	const ElementType& Last() const { return (*this)[Count - 1]; }
+
+	/// Adds an element at the back, overwriting the oldest element if we're full.
+	template <typename... ArgsType>
+	ElementType& Emplace(ArgsType&&... Args)
+	{
+		checkf(Capacity > 0, TEXT("TRGTrajectoryBuffer used before its capacity was set"));
+
+		if (ExternalStorage == nullptr && Storage.Num() != Capacity)
+		{
+			// Detached from external storage; carry on with our own.
+			SetCapacity(Capacity);
+		}
+
+		if (Count == Capacity)
+		{
+			Head = WrapIndex(Head + 1);
+			Count--;
+		}
+
+		ElementType& Slot = GetData()[WrapIndex(Head + Count)];
+		Slot = ElementType(Forward<ArgsType>(Args)...);
+		Count++;
+		return Slot;
+	}
+
+	void PopFront()
+	{
+		check(Count > 0);
+		Head = WrapIndex(Head + 1);
+		Count--;
+	}
+
+	void PopBack()
+	{
+		check(Count > 0);
+		Count--;
+	}
+
+	/// Empties the buffer, keeping its storage.
+	void Reset()
+	{
+		Head = 0;
+		Count = 0;
+	}
+
+	template <bool bConst>
+	struct TIterator
+	{
+		using BufferType = std::conditional_t<bConst, const TRGTrajectoryBuffer, TRGTrajectoryBuffer>;
+		using ReferenceType = std::conditional_t<bConst, const ElementType&, ElementType&>;
+
+		BufferType* Buffer;
+		int32 Index;
+
+		ReferenceType operator*() const { return (*Buffer)[Index]; }
+		TIterator& operator++() { ++Index; return *this; }
+		bool operator!=(const TIterator& Other) const { return Index != Other.Index; }
+	};
+
+	TIterator<false> begin() { return { this, 0 }; }
+	TIterator<false> end() { return { this, Count }; }
+	TIterator<true> begin() const { return { this, 0 }; }
+	TIterator<true> end() const { return { this, Count }; }
+
+private:
+
+	/// Indices never exceed twice the capacity, so a single subtraction is enough to wrap.
+	int32 WrapIndex(int32 Index) const { return Index >= Capacity ? Index - Capacity : Index; }
+
+	ElementType* GetData() { return ExternalStorage ? ExternalStorage : Storage.GetData(); }
+	const ElementType* GetData() const { return ExternalStorage ? ExternalStorage : Storage.GetData(); }
+
+	TArray<ElementType> Storage;
+	ElementType* ExternalStorage { nullptr };
+	int32 Capacity { 0 };
+	int32 Head { 0 };
+	int32 Count { 0 };
+};
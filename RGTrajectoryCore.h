@@ -0,0 +1,794 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+#pragma once
+
+// The trajectory math, free of any engine dependency, so that it can be built, benchmarked and iterated on
+// outside the editor (see Standalone/CMakeLists.txt). The engine-facing types (FRGTrajectoryModel,
+// URGTrajectoryMovementComponent) wrap what's here, converting to and from engine vectors at the edges.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/// Which closed-form movement model an FRGTrajectoryModel should use.
+enum class ERGTrajectoryModelType : uint8_t
+{
+	/// Planar movement with friction, braking and a turning acceleration.
+	Grounded,
+
+	/// A ballistic arc under gravity, with limited (air control) horizontal acceleration.
+	Ballistic,
+
+	/// Movement through a fluid, with velocity relaxing towards a drag-limited terminal velocity.
+	Drag
+};
+
+namespace RGTrajectoryCore
+{
+	constexpr double Pi = 3.1415926535897932;
+	constexpr double SmallNumber = 1.e-8;
+	constexpr double KindaSmallNumber = 1.e-4;
+
+	struct FVec2
+	{
+		double X { 0.0 };
+		double Y { 0.0 };
+
+		FVec2 operator+(const FVec2& O) const { return { X + O.X, Y + O.Y }; }
+		FVec2 operator-(const FVec2& O) const { return { X - O.X, Y - O.Y }; }
+		FVec2 operator*(double S) const { return { X * S, Y * S }; }
+		FVec2 operator/(double S) const { return { X / S, Y / S }; }
+		FVec2& operator+=(const FVec2& O) { X += O.X; Y += O.Y; return *this; }
+
+		double Dot(const FVec2& O) const { return X * O.X + Y * O.Y; }
+		double SizeSquared() const { return X * X + Y * Y; }
+		double Size() const { return std::sqrt(SizeSquared()); }
+		bool IsNearlyZero(double Tolerance = KindaSmallNumber) const { return std::abs(X) <= Tolerance && std::abs(Y) <= Tolerance; }
+
+		FVec2 GetSafeNormal() const
+		{
+			const double SquareSum = SizeSquared();
+			return SquareSum > SmallNumber ? *this / std::sqrt(SquareSum) : FVec2();
+		}
+
+		// Doubles as a complex number, X being the real part and Y the imaginary part.
+		FVec2 ComplexMul(const FVec2& O) const { return { X * O.X - Y * O.Y, X * O.Y + Y * O.X }; }
+		FVec2 ComplexDiv(const FVec2& O) const { return FVec2 { X * O.X + Y * O.Y, Y * O.X - X * O.Y } / O.SizeSquared(); }
+		static FVec2 ExpI(double Angle) { return { std::cos(Angle), std::sin(Angle) }; }
+	};
+
+	struct FVec3
+	{
+		double X { 0.0 };
+		double Y { 0.0 };
+		double Z { 0.0 };
+
+		FVec3() {}
+		FVec3(double InX, double InY, double InZ) : X(InX), Y(InY), Z(InZ) {}
+		FVec3(const FVec2& XY, double InZ) : X(XY.X), Y(XY.Y), Z(InZ) {}
+
+		FVec3 operator+(const FVec3& O) const { return { X + O.X, Y + O.Y, Z + O.Z }; }
+		FVec3 operator-(const FVec3& O) const { return { X - O.X, Y - O.Y, Z - O.Z }; }
+		FVec3 operator*(double S) const { return { X * S, Y * S, Z * S }; }
+		FVec3 operator/(double S) const { return { X / S, Y / S, Z / S }; }
+		bool operator==(const FVec3& O) const { return X == O.X && Y == O.Y && Z == O.Z; }
+
+		double Dot(const FVec3& O) const { return X * O.X + Y * O.Y + Z * O.Z; }
+		FVec3 Cross(const FVec3& O) const { return { Y * O.Z - Z * O.Y, Z * O.X - X * O.Z, X * O.Y - Y * O.X }; }
+		double SizeSquared() const { return X * X + Y * Y + Z * Z; }
+		double Size() const { return std::sqrt(SizeSquared()); }
+		FVec2 XY() const { return { X, Y }; }
+		bool IsNearlyZero(double Tolerance = KindaSmallNumber) const { return std::abs(X) <= Tolerance && std::abs(Y) <= Tolerance && std::abs(Z) <= Tolerance; }
+
+		FVec3 GetSafeNormal() const
+		{
+			const double SquareSum = SizeSquared();
+			return SquareSum > SmallNumber ? *this / std::sqrt(SquareSum) : FVec3();
+		}
+
+		FVec3 GetClampedToMaxSize(double MaxSize) const
+		{
+			const double SquareSum = SizeSquared();
+			return SquareSum > MaxSize * MaxSize ? GetSafeNormal() * MaxSize : *this;
+		}
+	};
+
+	// Angles
+
+	/// The angle, in degrees, between two vectors.
+	inline double AngleDifference(const FVec3& A, const FVec3& B)
+	{
+		const FVec3 ANorm = A.GetSafeNormal();
+		const FVec3 BNorm = B.GetSafeNormal();
+
+		// Why waste time on math if they're identical?
+		if (ANorm == BNorm) return 0.0;
+
+		return 180.0 / Pi * std::acos(std::clamp(ANorm.Dot(BNorm), -1.0, 1.0));
+	}
+
+	/// The signed angle, in degrees, by which B's yaw differs from A's.
+	inline double AngleDifferenceXY(const FVec3& A, const FVec3& B)
+	{
+		const FVec3 AXY(A.X, A.Y, 0.0);
+		const FVec3 BXY(B.X, B.Y, 0.0);
+		return AngleDifference(AXY, BXY) * (AXY.Cross(BXY).Z > 0.0 ? 1.0 : -1.0);
+	}
+
+	/// The signed angle, in degrees, by which B's ascent or descent differs from A's.
+	inline double AngleDifferenceZ(const FVec3& A, const FVec3& B)
+	{
+		const FVec3 AZ(0.0, 0.0, A.Z);
+		const FVec3 BZ(0.0, 0.0, B.Z);
+		return AngleDifference(AZ, BZ) * (AZ.Cross(BZ).Y > 0.0 ? 1.0 : -1.0);
+	}
+
+	// Stops and pivots
+
+	/// Where, relative to the pawn, grounded braking will bring it to a stop, and optionally how long that'll take.
+	inline FVec3 GroundedStopOffset(const FVec3& Velocity, double BrakingDeceleration, double Friction, double* OutSeconds = nullptr)
+	{
+		const FVec3 GroundedVelocity(Velocity.X, Velocity.Y, 0.0);
+		const double RealBrakingDeceleration = BrakingDeceleration * Friction;
+		if (OutSeconds) *OutSeconds = 0.0;
+		if (RealBrakingDeceleration <= 0.0) return FVec3();
+
+		if (OutSeconds) *OutSeconds = GroundedVelocity.Size() / RealBrakingDeceleration;
+		return GroundedVelocity.GetSafeNormal() * (GroundedVelocity.SizeSquared() / (2.0 * RealBrakingDeceleration));
+	}
+
+	/// Where, relative to the pawn, it'll finish reversing direction if accelerating against its velocity, and
+	/// optionally how long that'll take; zero if it isn't.
+	inline FVec3 GroundedPivotOffset(const FVec3& Acceleration, const FVec3& Velocity, double Friction, double* OutSeconds = nullptr)
+	{
+		if (OutSeconds) *OutSeconds = 0.0;
+
+		const FVec3 GroundedVelocity(Velocity.X, Velocity.Y, 0.0);
+		const FVec3 Acceleration2D(Acceleration.X, Acceleration.Y, 0.0);
+		const double AccelerationSize2D = Acceleration2D.Size();
+		const FVec3 AccelerationDir2D = AccelerationSize2D > SmallNumber ? Acceleration2D / AccelerationSize2D : FVec3();
+
+		const double VelocityAlongAcceleration = GroundedVelocity.Dot(AccelerationDir2D);
+		if (GroundedVelocity.Dot(Acceleration) >= 0.0 || VelocityAlongAcceleration >= 0.0) return FVec3();
+
+		const double SpeedAlongAcceleration = -VelocityAlongAcceleration;
+		const double TimeToDirectionChange = SpeedAlongAcceleration / (AccelerationSize2D + 2.0 * SpeedAlongAcceleration * Friction);
+		if (OutSeconds) *OutSeconds = TimeToDirectionChange;
+
+		const FVec3 AccelerationForce = Acceleration - (GroundedVelocity - AccelerationDir2D * GroundedVelocity.XY().Size()) * Friction;
+		return GroundedVelocity * TimeToDirectionChange + AccelerationForce * (0.5 * TimeToDirectionChange * TimeToDirectionChange);
+	}
+
+	// History
+
+	/// Whether a history sample SampleSeconds old (negative) should be culled, given how much history we keep
+	/// and the time horizon set when the pawn stopped (zero for none).
+	inline bool ShouldCullHistorySample(double SampleSeconds, double HistorySeconds, double TimeDomain)
+	{
+		const bool bTooOld = SampleSeconds < -HistorySeconds;
+		const bool bBeforeHorizon = TimeDomain != 0.0 && SampleSeconds < TimeDomain;
+		return bTooOld || bBeforeHorizon;
+	}
+
+	/// Updates the stopped-pawn time horizon for a new sample. While motionless, the horizon is pinned to the
+	/// oldest sample so that the history decays uniformly; once moving again, it's cleared.
+	inline double UpdateHistoryTimeDomain(double TimeDomain, bool bStopped, double OldestSampleSeconds)
+	{
+		if (!bStopped) return 0.0;
+		return TimeDomain == 0.0 ? OldestSampleSeconds : TimeDomain;
+	}
+
+	// Prediction
+
+	/// Starting state and movement parameters for an FTrajectoryModel.
+	struct FTrajectoryModelInput
+	{
+		ERGTrajectoryModelType Type { ERGTrajectoryModelType::Grounded };
+
+		FVec3 Location;
+		FVec3 Velocity;
+		FVec3 Acceleration;
+
+		/// Current turn rate, in degrees per second.
+		double YawRate { 0.0 };
+
+		/// Exponential decay rate of the turn rate, per second. Zero means the turn rate is held constant.
+		double YawRateDecay { 0.0 };
+
+		double BrakingDeceleration { 0.0 };
+		double Friction { 0.0 };
+		double MaxSpeed { 0.0 };
+
+		/// Ballistic only: gravitational acceleration.
+		FVec3 Gravity { 0.0, 0.0, -980.0 };
+
+		/// Ballistic only: the fraction of Acceleration which applies while in the air.
+		double AirControl { 0.0 };
+
+		/// Ballistic only: if set, the world Z at which we'll consider ourselves landed.
+		bool bHasLandingHeight { false };
+		double LandingHeight { 0.0 };
+
+		/// Drag only: how strongly the fluid resists movement, per second.
+		double Drag { 0.0 };
+
+		/// The furthest time we expect to be asked about; only used to decide how many turn segments to build.
+		double Horizon { 1.0 };
+	};
+
+	/// An analytic movement model; see FRGTrajectoryModel, which wraps this, for the details.
+	class FTrajectoryModel
+	{
+	public:
+
+		static constexpr int32_t MaxTurnSegments = 8;
+
+		void Initialize(const FTrajectoryModelInput& Input)
+		{
+			Type = Input.Type;
+			Origin = Input.Location;
+			YawRate = Input.YawRate;
+			YawRateDecay = std::max(Input.YawRateDecay, 0.0);
+			LandingTime = -1.0;
+
+			if (Type == ERGTrajectoryModelType::Ballistic)
+			{
+				InitializeBallistic(Input);
+				return;
+			}
+
+			if (Type == ERGTrajectoryModelType::Drag)
+			{
+				InitializeDrag(Input);
+				return;
+			}
+
+			const FVec2 Velocity2D = Input.Velocity.XY();
+			const FVec2 Acceleration2D = Input.Acceleration.XY();
+
+			bAccelerating = !Input.Acceleration.IsNearlyZero() && !Acceleration2D.IsNearlyZero();
+
+			if (!bAccelerating)
+			{
+				BrakingDirection = Velocity2D.GetSafeNormal();
+				StartSpeed = Velocity2D.Size();
+				BrakingDeceleration = std::max(Input.BrakingDeceleration, 0.0);
+				Friction = std::max(Input.Friction, 0.0);
+
+				if (StartSpeed <= SmallNumber)
+				{
+					StartSpeed = 0.0;
+					StopTime = 0.0;
+				}
+				else if (BrakingDeceleration > 0.0)
+				{
+					StopTime = Friction > 0.0 ?
+						std::log(1.0 + Friction * StartSpeed / BrakingDeceleration) / Friction :
+						StartSpeed / BrakingDeceleration;
+				}
+				else
+				{
+					StopTime = -1.0;
+				}
+
+				return;
+			}
+
+			AccelerationSize = Acceleration2D.Size();
+			TargetSpeed = std::max(Input.MaxSpeed, 0.0);
+			LateralDecay = std::max(Input.Friction, 0.0);
+
+			// Split a decaying turn into one segment per half-life of the turn rate, plus an open-ended tail which
+			// no longer turns. A constant turn rate only needs the single open-ended segment.
+			int32_t BoundedSegments = 0;
+			if (YawRateDecay > 0.0 && std::abs(YawRate) > SmallNumber)
+			{
+				SegmentDuration = 0.693147181 / YawRateDecay; // ln(2), one turn rate half-life
+				BoundedSegments = std::clamp(static_cast<int32_t>(std::ceil(Input.Horizon / SegmentDuration)), 1, MaxTurnSegments);
+			}
+			else
+			{
+				SegmentDuration = 0.0;
+			}
+
+			FTurnSegment& First = Segments[0];
+			First.StartTime = 0.0;
+			First.Heading = std::atan2(Acceleration2D.Y, Acceleration2D.X);
+			First.Location = FVec2();
+
+			// Velocity in the heading's frame: the along-track part is X, the lateral part Y.
+			const FVec2 Frame = FVec2::ExpI(First.Heading);
+			First.AlongSpeed = Velocity2D.Dot(Frame);
+			First.LateralSpeed = Velocity2D.Dot(FVec2 { -Frame.Y, Frame.X });
+
+			for (int32_t Idx = 0; Idx < BoundedSegments; Idx++)
+			{
+				FTurnSegment& Segment = Segments[Idx];
+				FTurnSegment& Next = Segments[Idx + 1];
+
+				Next.StartTime = SegmentDuration * (Idx + 1);
+				const double TurnRadians = DegreesToRadians(GetYawDeltaAt(Next.StartTime) - GetYawDeltaAt(Segment.StartTime));
+				Segment.TurnRate = TurnRadians / SegmentDuration;
+				Next.Heading = Segment.Heading + TurnRadians;
+
+				// Solve the end of this segment to use as the start of the next one.
+				EvaluateSegment(Segment, SegmentDuration, Next.Location, Next.AlongSpeed, Next.LateralSpeed);
+			}
+
+			NumSegments = BoundedSegments + 1;
+			Segments[BoundedSegments].TurnRate = BoundedSegments > 0 ? 0.0 : DegreesToRadians(YawRate);
+		}
+
+		/// Evaluate the model at the given number of seconds in the future. Yaw is returned as the change, in
+		/// degrees, from the starting yaw.
+		void Evaluate(double Seconds, FVec3& OutLocation, FVec3& OutVelocity, double& OutYawDelta) const
+		{
+			OutYawDelta = GetYawDeltaAt(Seconds);
+
+			if (Type == ERGTrajectoryModelType::Ballistic)
+			{
+				EvaluateBallistic(Seconds, OutLocation, OutVelocity);
+				return;
+			}
+
+			if (Type == ERGTrajectoryModelType::Drag)
+			{
+				EvaluateDrag(Seconds, OutLocation, OutVelocity);
+				return;
+			}
+
+			FVec2 Location2D;
+			FVec2 Velocity2D;
+			if (bAccelerating)
+			{
+				EvaluateAccelerating(Seconds, Location2D, Velocity2D);
+			}
+			else
+			{
+				EvaluateBraking(Seconds, Location2D, Velocity2D);
+			}
+
+			OutLocation = Origin + FVec3(Location2D, 0.0);
+			OutVelocity = FVec3(Velocity2D, 0.0);
+		}
+
+		/// If braking, how long until we come to a complete stop. Negative if we never stop (or aren't braking).
+		double GetStopTime() const { return bAccelerating ? -1.0 : StopTime; }
+
+		bool IsAccelerating() const { return bAccelerating; }
+
+		/// Ballistic only: the time until we reach the landing height. Negative if we never will.
+		double GetLandingTime() const { return LandingTime; }
+
+		/// Ballistic only: where we'll be when we land. Only valid if GetLandingTime is non-negative.
+		FVec3 GetLandingLocation() const
+		{
+			if (LandingTime < 0.0) return Origin;
+
+			FVec3 Location;
+			FVec3 Velocity;
+			EvaluateBallistic(LandingTime, Location, Velocity);
+			return Location;
+		}
+
+		ERGTrajectoryModelType GetType() const { return Type; }
+
+	private:
+
+		struct FTurnSegment;
+
+		static double DegreesToRadians(double Degrees) { return Degrees * (Pi / 180.0); }
+
+		void InitializeBallistic(const FTrajectoryModelInput& Input)
+		{
+			StartVelocity = Input.Velocity;
+
+			const FVec3 AirAcceleration = FVec3(Input.Acceleration.X, Input.Acceleration.Y, 0.0) * std::max(Input.AirControl, 0.0);
+			BallisticAcceleration = AirAcceleration + Input.Gravity;
+
+			// Air control can only push horizontal speed up to MaxSpeed; find when |V0 + A * t| reaches it, after
+			// which horizontal velocity is held.
+			CapTime = -1.0;
+			const FVec2 Velocity2D = StartVelocity.XY();
+			const FVec2 Acceleration2D = BallisticAcceleration.XY();
+			if (Input.MaxSpeed > 0.0 && !Acceleration2D.IsNearlyZero())
+			{
+				const double A = Acceleration2D.Dot(Acceleration2D);
+				const double B = 2.0 * Velocity2D.Dot(Acceleration2D);
+				const double C = Velocity2D.Dot(Velocity2D) - Input.MaxSpeed * Input.MaxSpeed;
+				const double Discriminant = B * B - 4.0 * A * C;
+
+				if ((C >= 0.0 && B >= 0.0) || Discriminant < 0.0)
+				{
+					CapTime = 0.0;
+				}
+				else
+				{
+					CapTime = std::max((-B + std::sqrt(Discriminant)) / (2.0 * A), 0.0);
+				}
+			}
+
+			// Landing is the descending crossing of the landing height.
+			const double GravityZ = BallisticAcceleration.Z;
+			if (Input.bHasLandingHeight && GravityZ < 0.0)
+			{
+				LandingHeight = Input.LandingHeight;
+
+				const double Drop = Origin.Z - LandingHeight;
+				const double Discriminant = StartVelocity.Z * StartVelocity.Z - 2.0 * GravityZ * Drop;
+				if (Discriminant >= 0.0)
+				{
+					const double Time = (-StartVelocity.Z - std::sqrt(Discriminant)) / GravityZ;
+					LandingTime = Time >= 0.0 ? Time : -1.0;
+				}
+			}
+		}
+
+		void InitializeDrag(const FTrajectoryModelInput& Input)
+		{
+			StartVelocity = Input.Velocity;
+			DragRate = std::max(Input.Drag, 0.0);
+
+			TerminalVelocity = DragRate > KindaSmallNumber ? Input.Acceleration / DragRate : StartVelocity;
+			if (Input.MaxSpeed > 0.0)
+			{
+				TerminalVelocity = TerminalVelocity.GetClampedToMaxSize(Input.MaxSpeed);
+			}
+		}
+
+		/// Total yaw change, in degrees, after the given number of seconds.
+		double GetYawDeltaAt(double Seconds) const
+		{
+			if (YawRateDecay > 0.0)
+			{
+				return YawRate * (1.0 - std::exp(-YawRateDecay * Seconds)) / YawRateDecay;
+			}
+
+			return YawRate * Seconds;
+		}
+
+		void EvaluateAccelerating(double Seconds, FVec2& OutLocation, FVec2& OutVelocity) const
+		{
+			const int32_t SegmentIdx = SegmentDuration > 0.0 ?
+				std::min(static_cast<int32_t>(std::floor(Seconds / SegmentDuration)), NumSegments - 1) : 0;
+			const FTurnSegment& Segment = Segments[std::max(SegmentIdx, 0)];
+
+			const double Tau = std::max(Seconds - Segment.StartTime, 0.0);
+			double AlongSpeed;
+			double LateralSpeed;
+			EvaluateSegment(Segment, Tau, OutLocation, AlongSpeed, LateralSpeed);
+
+			OutVelocity = FVec2::ExpI(Segment.Heading + Segment.TurnRate * Tau).ComplexMul(FVec2 { AlongSpeed, LateralSpeed });
+		}
+
+		/// Within a segment, the heading turns at a constant rate; along it, speed changes at AccelerationSize until
+		/// it reaches TargetSpeed and then holds, while any lateral speed decays under friction. Every part of that
+		/// integrates exactly.
+		void EvaluateSegment(const FTurnSegment& Segment, double Tau, FVec2& OutLocation, double& OutAlongSpeed, double& OutLateralSpeed) const
+		{
+			const double W = Segment.TurnRate;
+			const double SpeedGap = TargetSpeed - Segment.AlongSpeed;
+			const double RampAcceleration = SpeedGap >= 0.0 ? AccelerationSize : -AccelerationSize;
+			const double RampTime = AccelerationSize > SmallNumber ? std::abs(SpeedGap) / AccelerationSize : HUGE_VAL;
+			const double RampTau = std::min(Tau, RampTime);
+
+			OutAlongSpeed = Tau >= RampTime ? TargetSpeed : Segment.AlongSpeed + RampAcceleration * RampTau;
+			OutLateralSpeed = Segment.LateralSpeed * std::exp(-LateralDecay * Tau);
+
+			// Travel in the segment's starting frame: the ramp, then holding TargetSpeed, then the lateral drift.
+			const FVec2 RampRotationIntegral = RotationIntegral(W, RampTau);
+			FVec2 Travel = RampRotationIntegral * Segment.AlongSpeed + RampIntegral(W, RampTau) * RampAcceleration;
+			if (Tau > RampTau)
+			{
+				Travel += (RotationIntegral(W, Tau) - RampRotationIntegral) * TargetSpeed;
+			}
+			Travel += FVec2 { 0.0, Segment.LateralSpeed }.ComplexMul(DecayingRotationIntegral(LateralDecay, W, Tau));
+
+			OutLocation = Segment.Location + FVec2::ExpI(Segment.Heading).ComplexMul(Travel);
+		}
+
+		/// The integral of e^(i * W * t) from 0 to Tau.
+		static FVec2 RotationIntegral(double W, double Tau)
+		{
+			if (std::abs(W) <= KindaSmallNumber) return { Tau, 0.0 };
+			return (FVec2::ExpI(W * Tau) - FVec2 { 1.0, 0.0 }).ComplexDiv(FVec2 { 0.0, W });
+		}
+
+		/// The integral of t * e^(i * W * t) from 0 to Tau.
+		static FVec2 RampIntegral(double W, double Tau)
+		{
+			if (std::abs(W) <= KindaSmallNumber) return { 0.5 * Tau * Tau, 0.0 };
+			return (FVec2::ExpI(W * Tau) * Tau - RotationIntegral(W, Tau)).ComplexDiv(FVec2 { 0.0, W });
+		}
+
+		/// The integral of e^((i * W - Decay) * t) from 0 to Tau.
+		static FVec2 DecayingRotationIntegral(double Decay, double W, double Tau)
+		{
+			const FVec2 Rate { -Decay, W };
+			if (Rate.IsNearlyZero()) return { Tau, 0.0 };
+			return (FVec2::ExpI(W * Tau) * std::exp(-Decay * Tau) - FVec2 { 1.0, 0.0 }).ComplexDiv(Rate);
+		}
+
+		void EvaluateBraking(double Seconds, FVec2& OutLocation, FVec2& OutVelocity) const
+		{
+			if (StartSpeed == 0.0)
+			{
+				OutLocation = OutVelocity = FVec2();
+				return;
+			}
+
+			const double Time = StopTime >= 0.0 ? std::min(Seconds, StopTime) : Seconds;
+
+			double Speed;
+			double Distance;
+			if (Friction > 0.0)
+			{
+				// ds/dt = -Friction * s - BrakingDeceleration
+				const double Terminal = BrakingDeceleration / Friction;
+				const double Decay = std::exp(-Friction * Time);
+				Speed = (StartSpeed + Terminal) * Decay - Terminal;
+				Distance = (StartSpeed + Terminal) * (1.0 - Decay) / Friction - Terminal * Time;
+			}
+			else
+			{
+				Speed = StartSpeed - BrakingDeceleration * Time;
+				Distance = StartSpeed * Time - 0.5 * BrakingDeceleration * Time * Time;
+			}
+
+			if (StopTime >= 0.0 && Seconds >= StopTime)
+			{
+				Speed = 0.0;
+			}
+
+			OutVelocity = BrakingDirection * std::max(Speed, 0.0);
+			OutLocation = BrakingDirection * Distance;
+		}
+
+		void EvaluateBallistic(double Seconds, FVec3& OutLocation, FVec3& OutVelocity) const
+		{
+			// Vertical movement is a plain parabola until we land.
+			const double VerticalTime = LandingTime >= 0.0 ? std::min(Seconds, LandingTime) : Seconds;
+			const double Height = StartVelocity.Z * VerticalTime + 0.5 * BallisticAcceleration.Z * VerticalTime * VerticalTime;
+			const double VerticalSpeed = LandingTime >= 0.0 && Seconds >= LandingTime ? 0.0 : StartVelocity.Z + BallisticAcceleration.Z * VerticalTime;
+
+			// Horizontal movement accelerates until it reaches the speed cap, then coasts.
+			const FVec2 Velocity2D = StartVelocity.XY();
+			const FVec2 Acceleration2D = BallisticAcceleration.XY();
+			const double AcceleratingTime = CapTime >= 0.0 ? std::min(Seconds, CapTime) : Seconds;
+
+			const FVec2 HorizontalVelocity = Velocity2D + Acceleration2D * AcceleratingTime;
+			const FVec2 HorizontalTravel = Velocity2D * AcceleratingTime + Acceleration2D * (0.5 * AcceleratingTime * AcceleratingTime) +
+				HorizontalVelocity * (Seconds - AcceleratingTime);
+
+			OutLocation = Origin + FVec3(HorizontalTravel, Height);
+			OutVelocity = FVec3(HorizontalVelocity, VerticalSpeed);
+		}
+
+		void EvaluateDrag(double Seconds, FVec3& OutLocation, FVec3& OutVelocity) const
+		{
+			if (DragRate <= KindaSmallNumber)
+			{
+				OutLocation = Origin + StartVelocity * Seconds;
+				OutVelocity = StartVelocity;
+				return;
+			}
+
+			// dv/dt = Drag * (TerminalVelocity - v)
+			const double Decay = std::exp(-DragRate * Seconds);
+			const FVec3 Transient = StartVelocity - TerminalVelocity;
+
+			OutLocation = Origin + TerminalVelocity * Seconds + Transient * ((1.0 - Decay) / DragRate);
+			OutVelocity = TerminalVelocity + Transient * Decay;
+		}
+
+		// Shared state
+		ERGTrajectoryModelType Type { ERGTrajectoryModelType::Grounded };
+		FVec3 Origin;
+		double YawRate { 0.0 };
+		double YawRateDecay { 0.0 };
+		bool bAccelerating { false };
+
+		// Accelerating: speed along the acceleration direction changes at AccelerationSize until it reaches
+		// TargetSpeed, and speed across it decays at LateralDecay.
+		double AccelerationSize { 0.0 };
+		double TargetSpeed { 0.0 };
+		double LateralDecay { 0.0 };
+		double SegmentDuration { 0.0 };
+		int32_t NumSegments { 0 };
+
+		struct FTurnSegment
+		{
+			double StartTime { 0.0 };
+			double Heading { 0.0 };
+			double TurnRate { 0.0 };
+			FVec2 Location;
+
+			/// Velocity at the start of the segment, along and across Heading.
+			double AlongSpeed { 0.0 };
+			double LateralSpeed { 0.0 };
+		};
+
+		FTurnSegment Segments[MaxTurnSegments + 1];
+
+		// Braking: straight-line deceleration.
+		FVec2 BrakingDirection;
+		double StartSpeed { 0.0 };
+		double BrakingDeceleration { 0.0 };
+		double Friction { 0.0 };
+		double StopTime { -1.0 };
+
+		// Ballistic: constant acceleration, with horizontal speed capped once it reaches CapTime.
+		FVec3 StartVelocity;
+		FVec3 BallisticAcceleration;
+		double CapTime { -1.0 };
+		double LandingTime { -1.0 };
+		double LandingHeight { 0.0 };
+
+		// Drag: velocity relaxes exponentially towards TerminalVelocity.
+		FVec3 TerminalVelocity;
+		double DragRate { 0.0 };
+	};
+
+	/// Speed along a known path, for pawns following one. Speed changes at a constant acceleration until it reaches
+	/// MaxSpeed, just as it does along the grounded model's heading, until the pawn has to start braking (under friction and braking deceleration, again as in
+	/// the grounded model) to come to a stop at the end of the path.
+	class FPathSpeedProfile
+	{
+	public:
+
+		void Initialize(double StartSpeed, double Acceleration, double MaxSpeed, double InBrakingDeceleration, double InFriction, double PathLength)
+		{
+			Speed0 = std::max(StartSpeed, 0.0);
+			TargetSpeed = std::max(MaxSpeed, 0.0);
+			AccelerationSize = std::max(Acceleration, 0.0);
+			RampTime = AccelerationSize > SmallNumber ? std::abs(TargetSpeed - Speed0) / AccelerationSize : HUGE_VAL;
+			BrakingDeceleration = std::max(InBrakingDeceleration, 0.0);
+			Friction = std::max(InFriction, 0.0);
+			Length = std::max(PathLength, 0.0);
+
+			// Find when to start braking: the first moment at which the distance covered plus the distance needed to
+			// stop reaches the end of the path. That only ever grows once we're at speed, so bracket and bisect.
+			BrakeTime = 0.0;
+			if (Overshoot(0.0) < 0.0)
+			{
+				double Low = 0.0;
+				double High = 1.0;
+				for (int32_t Idx = 0; Idx < 16 && Overshoot(High) < 0.0; Idx++)
+				{
+					Low = High;
+					High *= 2.0;
+				}
+
+				for (int32_t Idx = 0; Idx < 32; Idx++)
+				{
+					const double Mid = 0.5 * (Low + High);
+					(Overshoot(Mid) < 0.0 ? Low : High) = Mid;
+				}
+
+				BrakeTime = High;
+			}
+
+			double BrakeDistance;
+			EvaluateAccelerating(BrakeTime, BrakeDistance, BrakeSpeed);
+			BrakeStartDistance = std::min(BrakeDistance, Length);
+			StopTime = BrakeTime + StoppingTime(BrakeSpeed);
+		}
+
+		/// Distance along the path, and speed, the given number of seconds from the start of the profile. Distance
+		/// never exceeds the path length.
+		void Evaluate(double Seconds, double& OutDistance, double& OutSpeed) const
+		{
+			if (Seconds < BrakeTime)
+			{
+				EvaluateAccelerating(Seconds, OutDistance, OutSpeed);
+			}
+			else
+			{
+				EvaluateBraking(Seconds - BrakeTime, OutDistance, OutSpeed);
+				OutDistance += BrakeStartDistance;
+			}
+
+			if (OutDistance >= Length)
+			{
+				OutDistance = Length;
+				OutSpeed = 0.0;
+			}
+		}
+
+		double GetLength() const { return Length; }
+
+		/// How long until we come to a stop at the end of the path. Negative if we never will.
+		double GetStopTime() const { return StopTime; }
+
+	private:
+
+		void EvaluateAccelerating(double Seconds, double& OutDistance, double& OutSpeed) const
+		{
+			// Constant acceleration towards TargetSpeed, then holding it.
+			const double RampAcceleration = TargetSpeed >= Speed0 ? AccelerationSize : -AccelerationSize;
+			const double RampSeconds = std::min(Seconds, RampTime);
+
+			OutSpeed = Seconds >= RampTime ? TargetSpeed : Speed0 + RampAcceleration * RampSeconds;
+			OutDistance = Speed0 * RampSeconds + 0.5 * RampAcceleration * RampSeconds * RampSeconds + TargetSpeed * (Seconds - RampSeconds);
+		}
+
+		void EvaluateBraking(double Seconds, double& OutDistance, double& OutSpeed) const
+		{
+			const double StopSeconds = StoppingTime(BrakeSpeed);
+			const double Time = StopSeconds >= 0.0 ? std::min(Seconds, StopSeconds) : Seconds;
+
+			if (Friction > 0.0)
+			{
+				// ds/dt = -Friction * s - BrakingDeceleration
+				const double Terminal = BrakingDeceleration / Friction;
+				const double Decay = std::exp(-Friction * Time);
+				OutSpeed = std::max((BrakeSpeed + Terminal) * Decay - Terminal, 0.0);
+				OutDistance = (BrakeSpeed + Terminal) * (1.0 - Decay) / Friction - Terminal * Time;
+			}
+			else
+			{
+				OutSpeed = std::max(BrakeSpeed - BrakingDeceleration * Time, 0.0);
+				OutDistance = BrakeSpeed * Time - 0.5 * BrakingDeceleration * Time * Time;
+			}
+		}
+
+		/// Time taken to brake to a stop from the given speed; negative if we never stop.
+		double StoppingTime(double Speed) const
+		{
+			if (Speed <= SmallNumber) return 0.0;
+			if (BrakingDeceleration <= 0.0) return -1.0;
+
+			return Friction > 0.0 ? std::log(1.0 + Friction * Speed / BrakingDeceleration) / Friction : Speed / BrakingDeceleration;
+		}
+
+		/// Distance covered braking to a stop from the given speed. Without braking deceleration, friction alone
+		/// only stops us asymptotically, but the distance is still finite.
+		double StoppingDistance(double Speed) const
+		{
+			if (Speed <= SmallNumber) return 0.0;
+
+			if (Friction > 0.0)
+			{
+				if (BrakingDeceleration <= 0.0) return Speed / Friction;
+
+				const double Terminal = BrakingDeceleration / Friction;
+				return Speed / Friction - Terminal * std::log(1.0 + Speed / Terminal) / Friction;
+			}
+
+			return BrakingDeceleration > 0.0 ? Speed * Speed / (2.0 * BrakingDeceleration) : HUGE_VAL;
+		}
+
+		/// How far past the end of the path we'd stop if we started braking at the given time.
+		double Overshoot(double Seconds) const
+		{
+			double Distance;
+			double Speed;
+			EvaluateAccelerating(Seconds, Distance, Speed);
+			return Distance + StoppingDistance(Speed) - Length;
+		}
+
+		double Speed0 { 0.0 };
+		double TargetSpeed { 0.0 };
+		double AccelerationSize { 0.0 };
+		double RampTime { 0.0 };
+		double BrakingDeceleration { 0.0 };
+		double Friction { 0.0 };
+		double Length { 0.0 };
+
+		double BrakeTime { 0.0 };
+		double BrakeSpeed { 0.0 };
+		double BrakeStartDistance { 0.0 };
+		double StopTime { -1.0 };
+	};
+}
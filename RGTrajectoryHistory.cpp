@@ -0,0 +1,140 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+#include "RGTrajectoryHistory.h"
+
+FRGTrajectoryKeyframe FRGTrajectoryKeyframe::Interpolate(const FRGTrajectoryKeyframe& From, const FRGTrajectoryKeyframe& To, double AtTime)
+{
+	const double Span = To.Time - From.Time;
+	const float Alpha = Span > SMALL_NUMBER ? FMath::Clamp(static_cast<float>((AtTime - From.Time) / Span), 0.f, 1.f) : 1.f;
+
+	FRGTrajectoryKeyframe Result;
+	Result.Time = AtTime;
+	Result.Location = FMath::Lerp(From.Location, To.Location, Alpha);
+	Result.Rotation = FQuat::Slerp(From.Rotation, To.Rotation, Alpha);
+	Result.Velocity = FMath::Lerp(From.Velocity, To.Velocity, Alpha);
+	return Result;
+}
+
+void FRGTrajectoryKeyframeHistory::SetCapacity(int32 MaxKeyframes)
+{
+	Keyframes.SetCapacity(FMath::Max(MaxKeyframes, 2));
+	Window.Reset();
+}
+
+void FRGTrajectoryKeyframeHistory::Add(const FRGTrajectoryKeyframe& Point)
+{
+	if (Keyframes.GetCapacity() == 0)
+	{
+		SetCapacity(DefaultCapacity);
+	}
+
+	if (Keyframes.IsEmpty())
+	{
+		Keyframes.Emplace(Point);
+		return;
+	}
+
+	if (!Window.IsEmpty() && (Window.Num() >= MaxWindow || !IsWithinTolerance(Keyframes.Last(), Point)))
+	{
+		// The open segment can't stretch to reach this point, so close it where it last ended.
+		Keyframes.Emplace(Window.Last());
+		Window.Reset();
+	}
+
+	Window.Add(Point);
+}
+
+bool FRGTrajectoryKeyframeHistory::IsWithinTolerance(const FRGTrajectoryKeyframe& From, const FRGTrajectoryKeyframe& To) const
+{
+	const float PositionToleranceSquared = FMath::Square(PositionTolerance);
+	const float RotationToleranceRadians = FMath::DegreesToRadians(RotationTolerance);
+
+	for (const FRGTrajectoryKeyframe& Point : Window)
+	{
+		const FRGTrajectoryKeyframe Interpolated = FRGTrajectoryKeyframe::Interpolate(From, To, Point.Time);
+		if (FVector::DistSquared(Interpolated.Location, Point.Location) > PositionToleranceSquared ||
+			Interpolated.Rotation.AngularDistance(Point.Rotation) > RotationToleranceRadians)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FRGTrajectoryKeyframeHistory::CullBefore(double Time)
+{
+	while (Keyframes.Num() > 1 && Keyframes[1].Time <= Time)
+	{
+		Keyframes.PopFront();
+	}
+}
+
+void FRGTrajectoryKeyframeHistory::DiscardAfter(double Time)
+{
+	while (!Window.IsEmpty() && Window.Last().Time > Time)
+	{
+		Window.Pop(false);
+	}
+
+	if (Window.IsEmpty())
+	{
+		while (!Keyframes.IsEmpty() && Keyframes.Last().Time > Time)
+		{
+			Keyframes.PopBack();
+		}
+	}
+}
+
+void FRGTrajectoryKeyframeHistory::Reset()
+{
+	Keyframes.Reset();
+	Window.Reset();
+}
+
+bool FRGTrajectoryKeyframeHistory::Sample(double Time, FRGTrajectoryKeyframe& OutKeyframe) const
+{
+	const int32 Count = Num();
+	if (Count == 0) return false;
+
+	if (Time <= First().Time)
+	{
+		OutKeyframe = First();
+		return true;
+	}
+
+	if (Time >= Last().Time)
+	{
+		OutKeyframe = Last();
+		return true;
+	}
+
+	// Find the last point at or before the requested time.
+	int32 Low = 0;
+	int32 High = Count - 1;
+	while (High - Low > 1)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if ((*this)[Mid].Time <= Time)
+		{
+			Low = Mid;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	OutKeyframe = FRGTrajectoryKeyframe::Interpolate((*this)[Low], (*this)[High], Time);
+	return true;
+}
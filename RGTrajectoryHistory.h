@@ -0,0 +1,111 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RGMotionEstimator.h"
+#include "RGMovementSample.h"
+#include "RGTrajectoryBuffer.h"
+
+/// A movement history sample, stored relative to its owner's history anchor against GMC's synchronized time.
+/// The world and relative parts of the sample are only worked out when the history is read.
+struct ROOICORE_API FRGTrajectoryHistoryEntry
+{
+	uint64 Sequence { 0 };
+	double Time { 0.0 };
+	FRGMovementSample Sample;
+
+	/// The motion estimate as of this sample, so that rewinding the history rewinds the estimate too.
+	FRGMotionEstimator Estimator;
+};
+
+/// A compressed long-horizon history point: just enough to say where the pawn was, which way it faced, and how
+/// fast it was going. Stored in the same anchor space as FRGTrajectoryHistoryEntry.
+struct ROOICORE_API FRGTrajectoryKeyframe
+{
+	double Time { 0.0 };
+	FVector Location { 0.f };
+	FQuat Rotation { FQuat::Identity };
+	FVector Velocity { 0.f };
+
+	FRGTrajectoryKeyframe() {}
+
+	explicit FRGTrajectoryKeyframe(const FRGTrajectoryHistoryEntry& Entry)
+		: Time(Entry.Time)
+		, Location(Entry.Sample.WorldTransform.GetLocation())
+		, Rotation(Entry.Sample.WorldTransform.GetRotation())
+		, Velocity(Entry.Sample.WorldLinearVelocity)
+	{
+	}
+
+	/// Interpolates between two keyframes at the given time, which should lie between them.
+	static FRGTrajectoryKeyframe Interpolate(const FRGTrajectoryKeyframe& From, const FRGTrajectoryKeyframe& To, double AtTime);
+};
+
+/// Keyframes for the long tail of the movement history, compressed online as entries age out of the full-rate
+/// history. Each new point extends the current segment for as long as every point it replaces stays within
+/// tolerance of it (measured at the same moment in time, so interpolated queries stay within tolerance too);
+/// once one wouldn't, the segment is closed with a keyframe. This is the streaming form of Ramer-Douglas-Peucker
+/// simplification, and costs at most MaxWindow checks per point.
+///
+/// Memory is bounded by the keyframe capacity; once full, the oldest keyframe is overwritten.
+class ROOICORE_API FRGTrajectoryKeyframeHistory
+{
+public:
+
+	/// The most points a single segment may replace before it's closed regardless.
+	static constexpr int32 MaxWindow = 32;
+
+	/// How many keyframes we keep if points are added before SetCapacity is called.
+	static constexpr int32 DefaultCapacity = 16;
+
+	/// Sets the maximum number of keyframes kept, discarding the current contents.
+	void SetCapacity(int32 MaxKeyframes);
+
+	/// Adds a point, which must be later than any already added.
+	void Add(const FRGTrajectoryKeyframe& Point);
+
+	/// Drops keyframes from before the given time, keeping one so that queries reaching back to it still have
+	/// something to interpolate from.
+	void CullBefore(double Time);
+
+	/// Drops everything after the given time.
+	void DiscardAfter(double Time);
+
+	void Reset();
+
+	/// Keyframes plus the newest point, if it hasn't yet been closed into a keyframe.
+	int32 Num() const { return Keyframes.Num() + (Window.IsEmpty() ? 0 : 1); }
+	bool IsEmpty() const { return Num() == 0; }
+	const FRGTrajectoryKeyframe& operator[](int32 Index) const { return Index < Keyframes.Num() ? Keyframes[Index] : Window.Last(); }
+	const FRGTrajectoryKeyframe& First() const { return (*this)[0]; }
+	const FRGTrajectoryKeyframe& Last() const { return (*this)[Num() - 1]; }
+
+	/// Interpolates the history at the given time, clamped to the span we cover. Returns false if empty.
+	bool Sample(double Time, FRGTrajectoryKeyframe& OutKeyframe) const;
+
+	/// How far, in units, an interpolated position may stray from the recorded one.
+	float PositionTolerance { 5.f };
+
+	/// How far, in degrees, an interpolated rotation may stray from the recorded one.
+	float RotationTolerance { 5.f };
+
+private:
+
+	bool IsWithinTolerance(const FRGTrajectoryKeyframe& From, const FRGTrajectoryKeyframe& To) const;
+
+	TRGTrajectoryBuffer<FRGTrajectoryKeyframe> Keyframes;
+
+	/// Points since the last keyframe, oldest first; the last one is the end of the open segment.
+	TArray<FRGTrajectoryKeyframe, TInlineAllocator<MaxWindow>> Window;
+};
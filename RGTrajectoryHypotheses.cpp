@@ -0,0 +1,82 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+#include "RGTrajectoryHypotheses.h"
+
+void FRGTrajectoryHypothesisSet::Reset(TConstArrayView<ERGTrajectoryHypothesis> InHypotheses, int32 InNumShared,
+	int32 InNumDivergent, float InTimePerSample, const FTransform& InOrigin)
+{
+	Hypotheses.Reset();
+	Hypotheses.Append(InHypotheses.GetData(), InHypotheses.Num());
+	NumShared = FMath::Max(InNumShared, 0);
+	NumDivergent = FMath::Max(InNumDivergent, 0);
+	TimePerSample = InTimePerSample;
+	Origin = InOrigin;
+
+	ChannelStride = NumShared + Hypotheses.Num() * NumDivergent;
+	Data.SetNumUninitialized(ChannelStride * NumChannels, false);
+}
+
+void FRGTrajectoryHypothesisSet::SetSample(int32 HypothesisIdx, int32 SampleIdx, const FVector& Location,
+	const FVector& Velocity, float InYaw)
+{
+	const int32 Idx = GetStorageIndex(HypothesisIdx, SampleIdx);
+	const FVector Relative = Location - Origin.GetLocation();
+
+	Channel(X)[Idx] = Relative.X;
+	Channel(Y)[Idx] = Relative.Y;
+	Channel(Z)[Idx] = Relative.Z;
+	Channel(VelocityX)[Idx] = Velocity.X;
+	Channel(VelocityY)[Idx] = Velocity.Y;
+	Channel(VelocityZ)[Idx] = Velocity.Z;
+	Channel(Yaw)[Idx] = InYaw;
+}
+
+FVector FRGTrajectoryHypothesisSet::GetLocation(int32 HypothesisIdx, int32 SampleIdx) const
+{
+	const int32 Idx = GetStorageIndex(HypothesisIdx, SampleIdx);
+	return Origin.GetLocation() + FVector(Channel(X)[Idx], Channel(Y)[Idx], Channel(Z)[Idx]);
+}
+
+FVector FRGTrajectoryHypothesisSet::GetVelocity(int32 HypothesisIdx, int32 SampleIdx) const
+{
+	const int32 Idx = GetStorageIndex(HypothesisIdx, SampleIdx);
+	return FVector(Channel(VelocityX)[Idx], Channel(VelocityY)[Idx], Channel(VelocityZ)[Idx]);
+}
+
+FRGMovementSample FRGTrajectoryHypothesisSet::GetSample(int32 HypothesisIdx, int32 SampleIdx) const
+{
+	// The models only turn yaw, so pitch and roll are the origin's.
+	FRotator Rotation = Origin.Rotator();
+	Rotation.Yaw = GetYaw(HypothesisIdx, SampleIdx);
+
+	const FTransform WorldTransform(Rotation, GetLocation(HypothesisIdx, SampleIdx));
+	const FVector Velocity = GetVelocity(HypothesisIdx, SampleIdx);
+
+	FRGMovementSample Result;
+	Result.AccumulatedSeconds = GetSampleSeconds(SampleIdx);
+	Result.WorldTransform = WorldTransform;
+	Result.WorldLinearVelocity = Velocity;
+	Result.RelativeTransform = WorldTransform.GetRelativeTransform(Origin);
+	Result.RelativeLinearVelocity = Origin.InverseTransformVectorNoScale(Velocity);
+	return Result;
+}
+
+void FRGTrajectoryHypothesisSet::GetTrajectory(int32 HypothesisIdx, TArray<FRGMovementSample>& OutSamples) const
+{
+	OutSamples.Reset(NumSamples());
+	for (int32 SampleIdx = 0; SampleIdx < NumSamples(); SampleIdx++)
+	{
+		OutSamples.Add(GetSample(HypothesisIdx, SampleIdx));
+	}
+}
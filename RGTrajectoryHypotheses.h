@@ -0,0 +1,101 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RGMovementSample.h"
+#include "RGTrajectoryHypotheses.generated.h"
+
+/// A hypothetical change of input, to predict a candidate future from.
+UENUM(BlueprintType)
+enum class ERGTrajectoryHypothesis : uint8
+{
+	/// Carry on as we are; the same future PredictMovementFuture's movement model gives.
+	Continue,
+
+	/// Release input, and brake to a stop.
+	Stop,
+
+	/// Turn hard left or right, by the component's HypothesisTurnAngle.
+	TurnLeft,
+	TurnRight
+};
+
+/// Several candidate futures for one pawn. Every hypothesis shares the samples up to the point where they
+/// diverge, which are stored once; after that each has its own tail. Samples are stored as separate arrays
+/// of single-precision components relative to the origin they were predicted from, which keeps the set
+/// compact and lets each sample time be filled in for every hypothesis side by side.
+struct ROOICORE_API FRGTrajectoryHypothesisSet
+{
+	/// Sizes the set for the given hypotheses, discarding the current contents. Keeps its allocation if it's
+	/// big enough, so that a set can be reused from frame to frame.
+	void Reset(TConstArrayView<ERGTrajectoryHypothesis> InHypotheses, int32 InNumShared, int32 InNumDivergent, float InTimePerSample, const FTransform& InOrigin);
+
+	int32 NumHypotheses() const { return Hypotheses.Num(); }
+	ERGTrajectoryHypothesis GetHypothesis(int32 HypothesisIdx) const { return Hypotheses[HypothesisIdx]; }
+
+	/// Samples per hypothesis, shared ones included.
+	int32 NumSamples() const { return NumShared + NumDivergent; }
+
+	/// How many of each hypothesis' samples are shared with every other hypothesis.
+	int32 NumSharedSamples() const { return NumShared; }
+
+	/// Seconds from the origin to the given sample; samples start one step in.
+	float GetSampleSeconds(int32 SampleIdx) const { return TimePerSample * (SampleIdx + 1); }
+
+	const FTransform& GetOrigin() const { return Origin; }
+
+	/// Stores a sample. A shared sample index stores the sample for every hypothesis at once.
+	void SetSample(int32 HypothesisIdx, int32 SampleIdx, const FVector& Location, const FVector& Velocity, float Yaw);
+
+	FVector GetLocation(int32 HypothesisIdx, int32 SampleIdx) const;
+	FVector GetVelocity(int32 HypothesisIdx, int32 SampleIdx) const;
+	float GetYaw(int32 HypothesisIdx, int32 SampleIdx) const { return Channel(Yaw)[GetStorageIndex(HypothesisIdx, SampleIdx)]; }
+
+	/// Expands a stored sample into a full movement sample, relative to the origin.
+	FRGMovementSample GetSample(int32 HypothesisIdx, int32 SampleIdx) const;
+
+	/// Expands one hypothesis into a full trajectory, reusing the array's allocation.
+	void GetTrajectory(int32 HypothesisIdx, TArray<FRGMovementSample>& OutSamples) const;
+
+private:
+
+	enum EChannel
+	{
+		X, Y, Z,
+		VelocityX, VelocityY, VelocityZ,
+		Yaw,
+		NumChannels
+	};
+
+	/// Shared samples first, then each hypothesis' divergent samples in turn.
+	int32 GetStorageIndex(int32 HypothesisIdx, int32 SampleIdx) const
+	{
+		checkSlow(Hypotheses.IsValidIndex(HypothesisIdx) && SampleIdx >= 0 && SampleIdx < NumSamples());
+		return SampleIdx < NumShared ? SampleIdx : NumShared + HypothesisIdx * NumDivergent + (SampleIdx - NumShared);
+	}
+
+	float* Channel(EChannel Idx) { return Data.GetData() + Idx * ChannelStride; }
+	const float* Channel(EChannel Idx) const { return Data.GetData() + Idx * ChannelStride; }
+
+	TArray<ERGTrajectoryHypothesis, TInlineAllocator<4>> Hypotheses;
+	int32 NumShared { 0 };
+	int32 NumDivergent { 0 };
+	float TimePerSample { 0.f };
+	FTransform Origin { FTransform::Identity };
+
+	/// Every channel in one allocation, each ChannelStride floats long.
+	TArray<float> Data;
+	int32 ChannelStride { 0 };
+};
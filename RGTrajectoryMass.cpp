@@ -0,0 +1,154 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+#include "RGTrajectoryMass.h"
+#include "MassCommonFragments.h"
+#include "MassCommonTypes.h"
+#include "MassEntityTemplateRegistry.h"
+#include "MassEntityUtils.h"
+#include "MassExecutionContext.h"
+#include "MassMovementFragments.h"
+#include "MassNavigationFragments.h"
+#include "RGTrajectoryModel.h"
+
+void URGTrajectoryMassTrait::BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, const UWorld& World) const
+{
+	BuildContext.RequireFragment<FTransformFragment>();
+	BuildContext.RequireFragment<FMassVelocityFragment>();
+
+	BuildContext.AddFragment<FRGTrajectoryMassHistoryFragment>();
+	BuildContext.AddFragment<FRGTrajectoryMassStateFragment>();
+	BuildContext.AddFragment<FRGTrajectoryMassPredictionFragment>();
+
+	FMassEntityManager& EntityManager = UE::Mass::Utils::GetEntityManagerChecked(World);
+	BuildContext.AddConstSharedFragment(EntityManager.GetOrCreateConstSharedFragment(Parameters));
+}
+
+URGTrajectoryMassProcessor::URGTrajectoryMassProcessor()
+	: EntityQuery(*this)
+{
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::All);
+	ExecutionOrder.ExecuteAfter.Add(UE::Mass::ProcessorGroupNames::Movement);
+}
+
+void URGTrajectoryMassProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FMassVelocityFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FMassSteeringFragment>(EMassFragmentAccess::ReadOnly, EMassFragmentPresence::Optional);
+	EntityQuery.AddRequirement<FRGTrajectoryMassHistoryFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FRGTrajectoryMassStateFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FRGTrajectoryMassPredictionFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddConstSharedRequirement<FRGTrajectoryMassParameters>();
+}
+
+void URGTrajectoryMassProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	const UWorld* World = EntityManager.GetWorld();
+	if (World == nullptr) return;
+
+	const double Time = World->GetTimeSeconds();
+
+	// Agents are independent of each other, so chunks can be spread across workers freely.
+	EntityQuery.ParallelForEachEntityChunk(EntityManager, Context, [Time](FMassExecutionContext& ChunkContext)
+	{
+		const FRGTrajectoryMassParameters& Parameters = ChunkContext.GetConstSharedFragment<FRGTrajectoryMassParameters>();
+		const TConstArrayView<FTransformFragment> Transforms = ChunkContext.GetFragmentView<FTransformFragment>();
+		const TConstArrayView<FMassVelocityFragment> Velocities = ChunkContext.GetFragmentView<FMassVelocityFragment>();
+		const TConstArrayView<FMassSteeringFragment> Steering = ChunkContext.GetFragmentView<FMassSteeringFragment>();
+		const TArrayView<FRGTrajectoryMassHistoryFragment> Histories = ChunkContext.GetMutableFragmentView<FRGTrajectoryMassHistoryFragment>();
+		const TArrayView<FRGTrajectoryMassStateFragment> States = ChunkContext.GetMutableFragmentView<FRGTrajectoryMassStateFragment>();
+		const TArrayView<FRGTrajectoryMassPredictionFragment> Predictions = ChunkContext.GetMutableFragmentView<FRGTrajectoryMassPredictionFragment>();
+
+		for (int32 Idx = 0; Idx < ChunkContext.GetNumEntities(); Idx++)
+		{
+			const FVector DesiredVelocity = Steering.IsEmpty() ? Velocities[Idx].Value : Steering[Idx].DesiredVelocity;
+			UpdateAgent(Parameters, Time, Transforms[Idx].GetTransform(), Velocities[Idx].Value, DesiredVelocity,
+				Histories[Idx], States[Idx], Predictions[Idx]);
+		}
+	});
+}
+
+void URGTrajectoryMassProcessor::UpdateAgent(const FRGTrajectoryMassParameters& Parameters, double Time,
+	const FTransform& Transform, const FVector& Velocity, const FVector& DesiredVelocity,
+	FRGTrajectoryMassHistoryFragment& History, FRGTrajectoryMassStateFragment& State,
+	FRGTrajectoryMassPredictionFragment& Prediction)
+{
+	const FVector Location = Transform.GetLocation();
+	const FRotator Rotation = Transform.Rotator();
+
+	// History, culled the same way the component culls it (less the stopped time horizon, which only matters for
+	// distance matching into a stop, and which ambient agents can do without).
+	if (History.IsEmpty() || Time - History.Last().Time >= Parameters.HistorySampleInterval)
+	{
+		FRGTrajectoryMassSample Sample;
+		Sample.Time = Time;
+		Sample.Location = Location;
+		Sample.Velocity = Velocity;
+		Sample.Yaw = Rotation.Yaw;
+		History.Add(Sample);
+	}
+
+	while (History.Num() > 1 && RGTrajectoryCore::ShouldCullHistorySample(History.First().Time - Time, Parameters.HistorySeconds, 0.0))
+	{
+		History.PopFront();
+	}
+
+	State.Estimator.SmoothingTime = Parameters.EstimatorSmoothingTime;
+	State.Estimator.AccelerationSmoothingTime = Parameters.EstimatorSmoothingTime * 2.f;
+	State.Estimator.Update(Time, Location, Velocity, Rotation, true);
+
+	// An agent's desired velocity is its input.
+	State.bInputPresent = !DesiredVelocity.IsNearlyZero();
+	const FVector Acceleration = State.bInputPresent ? DesiredVelocity.GetSafeNormal() * Parameters.MaxAcceleration : FVector::ZeroVector;
+
+	double StopSeconds;
+	State.StopPoint = RGTrajectoryCore::ToEngine(RGTrajectoryCore::GroundedStopOffset(RGTrajectoryCore::ToCore(Velocity),
+		Parameters.BrakingDeceleration, Parameters.GroundFriction, &StopSeconds));
+	State.StopSeconds = StopSeconds;
+	State.bIsStopping = !State.StopPoint.IsZero() && !State.bInputPresent;
+
+	double PivotSeconds;
+	State.PivotPoint = RGTrajectoryCore::ToEngine(RGTrajectoryCore::GroundedPivotOffset(RGTrajectoryCore::ToCore(Acceleration),
+		RGTrajectoryCore::ToCore(Velocity), Parameters.GroundFriction, &PivotSeconds));
+	State.PivotSeconds = PivotSeconds;
+	State.bIsPivoting = !State.PivotPoint.IsZero() && State.bInputPresent;
+
+	Prediction.Count = FMath::Clamp(Parameters.PredictionSamples, 0, FRGTrajectoryMassPredictionFragment::MaxSamples);
+	if (Prediction.Count == 0) return;
+
+	FRGTrajectoryModelInput Input;
+	Input.Location = Location;
+	Input.Rotation = Rotation;
+	Input.Velocity = Velocity;
+	Input.Acceleration = Acceleration;
+	Input.YawRate = State.Estimator.IsValid() ? State.Estimator.GetYawRate() : 0.f;
+	Input.YawRateDecay = Parameters.TurnRateDecay;
+	Input.BrakingDeceleration = Parameters.BrakingDeceleration;
+	Input.Friction = Parameters.GroundFriction;
+	Input.MaxSpeed = Parameters.MaxSpeed;
+	Input.Horizon = Parameters.PredictionSeconds;
+
+	FRGTrajectoryModel Model;
+	Model.Initialize(Input);
+
+	const float TimePerSample = Parameters.PredictionSeconds / Prediction.Count;
+	for (int32 Idx = 0; Idx < Prediction.Count; Idx++)
+	{
+		FRGTrajectoryMassSample& Sample = Prediction.Samples[Idx];
+		FRotator SampleRotation;
+		Sample.Time = TimePerSample * (Idx + 1);
+		Model.Evaluate(Sample.Time, Sample.Location, Sample.Velocity, SampleRotation);
+		Sample.Yaw = SampleRotation.Yaw;
+	}
+}
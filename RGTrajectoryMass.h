@@ -0,0 +1,214 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTraitBase.h"
+#include "MassEntityTypes.h"
+#include "MassProcessor.h"
+#include "RGMotionEstimator.h"
+#include "RGTrajectoryMass.generated.h"
+
+// Trajectory history, stop and pivot prediction and future paths for Mass agents, such as ambient crowds, which
+// can't each afford a URGTrajectoryMovementComponent. The math is the same as the component's; the state lives in
+// fragments, and a processor updates every agent chunk by chunk, in parallel. An agent promoted to a full pawn can
+// hand its state over with URGTrajectoryMovementComponent::ImportMassTrajectory (and back again with
+// ExportMassTrajectory) without a break in its history.
+
+/// A single trajectory point for a Mass agent, in world space.
+USTRUCT()
+struct ROOICORE_API FRGTrajectoryMassSample
+{
+	GENERATED_BODY()
+
+	/// For history, the world time of the sample; for prediction, seconds from now.
+	double Time { 0.0 };
+	FVector Location { 0.f };
+	FVector Velocity { 0.f };
+	float Yaw { 0.f };
+};
+
+/// An agent's recent movement, oldest first. A fixed-size ring, so that agents never allocate and the fragment
+/// stays trivially copyable.
+USTRUCT()
+struct ROOICORE_API FRGTrajectoryMassHistoryFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	static constexpr int32 MaxSamples = 32;
+
+	int32 Num() const { return Count; }
+	bool IsEmpty() const { return Count == 0; }
+
+	const FRGTrajectoryMassSample& operator[](int32 Index) const
+	{
+		checkSlow(Index >= 0 && Index < Count);
+		return Samples[(Head + Index) % MaxSamples];
+	}
+
+	const FRGTrajectoryMassSample& First() const { return (*this)[0]; }
+	const FRGTrajectoryMassSample& Last() const { return (*this)[Count - 1]; }
+
+	/// Adds a sample at the back, overwriting the oldest if we're full.
+	void Add(const FRGTrajectoryMassSample& Sample)
+	{
+		if (Count == MaxSamples)
+		{
+			PopFront();
+		}
+		Samples[(Head + Count) % MaxSamples] = Sample;
+		Count++;
+	}
+
+	void PopFront()
+	{
+		check(Count > 0);
+		Head = (Head + 1) % MaxSamples;
+		Count--;
+	}
+
+	void Reset()
+	{
+		Head = 0;
+		Count = 0;
+	}
+
+private:
+
+	FRGTrajectoryMassSample Samples[MaxSamples];
+	int32 Head { 0 };
+	int32 Count { 0 };
+};
+
+/// An agent's motion estimate, and its predicted stop and pivot.
+USTRUCT()
+struct ROOICORE_API FRGTrajectoryMassStateFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FRGMotionEstimator Estimator;
+
+	bool bIsStopping { false };
+
+	/// Relative to the agent.
+	FVector StopPoint { 0.f };
+	float StopSeconds { 0.f };
+
+	bool bIsPivoting { false };
+
+	/// Relative to the agent.
+	FVector PivotPoint { 0.f };
+	float PivotSeconds { 0.f };
+
+	/// Whether the agent had a desired velocity last update.
+	bool bInputPresent { false };
+};
+
+/// An agent's predicted future, evenly spaced and soonest first.
+USTRUCT()
+struct ROOICORE_API FRGTrajectoryMassPredictionFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	static constexpr int32 MaxSamples = 16;
+
+	TConstArrayView<FRGTrajectoryMassSample> GetSamples() const { return MakeArrayView(Samples, Count); }
+
+	FRGTrajectoryMassSample Samples[MaxSamples];
+	int32 Count { 0 };
+};
+
+/// Movement and trajectory settings, shared by every agent of a config. These stand in for the movement
+/// component properties the component version reads.
+USTRUCT()
+struct ROOICORE_API FRGTrajectoryMassParameters : public FMassSharedFragment
+{
+	GENERATED_BODY()
+
+	/// How much history to keep, in seconds.
+	UPROPERTY(EditAnywhere, Category="Trajectory", meta=(ClampMin=0))
+	float HistorySeconds { 1.f };
+
+	/// Minimum time between history samples; with at most FRGTrajectoryMassHistoryFragment::MaxSamples samples,
+	/// this wants to be at least HistorySeconds divided by that.
+	UPROPERTY(EditAnywhere, Category="Trajectory", meta=(ClampMin=0))
+	float HistorySampleInterval { 1.f / 30.f };
+
+	UPROPERTY(EditAnywhere, Category="Trajectory", meta=(ClampMin=0))
+	float PredictionSeconds { 1.f };
+
+	/// Zero disables prediction, leaving just history and stop/pivot prediction.
+	UPROPERTY(EditAnywhere, Category="Trajectory", meta=(ClampMin=0, ClampMax=16))
+	int32 PredictionSamples { 10 };
+
+	/// The acceleration an agent's desired velocity stands for.
+	UPROPERTY(EditAnywhere, Category="Trajectory", meta=(ClampMin=0))
+	float MaxAcceleration { 2048.f };
+
+	UPROPERTY(EditAnywhere, Category="Trajectory", meta=(ClampMin=0))
+	float BrakingDeceleration { 2048.f };
+
+	UPROPERTY(EditAnywhere, Category="Trajectory", meta=(ClampMin=0))
+	float GroundFriction { 8.f };
+
+	UPROPERTY(EditAnywhere, Category="Trajectory", meta=(ClampMin=0))
+	float MaxSpeed { 600.f };
+
+	UPROPERTY(EditAnywhere, Category="Trajectory", meta=(ClampMin=0))
+	float TurnRateDecay { 2.859f };
+
+	UPROPERTY(EditAnywhere, Category="Trajectory", meta=(ClampMin=0))
+	float EstimatorSmoothingTime { 0.05f };
+};
+
+/// Gives an agent trajectory history and prediction. Requires a transform and velocity; a steering fragment's
+/// desired velocity, if present, is treated as input.
+UCLASS(meta=(DisplayName="RG Trajectory"))
+class ROOICORE_API URGTrajectoryMassTrait : public UMassEntityTraitBase
+{
+	GENERATED_BODY()
+
+protected:
+
+	virtual void BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, const UWorld& World) const override;
+
+	UPROPERTY(EditAnywhere, Category="Trajectory")
+	FRGTrajectoryMassParameters Parameters;
+};
+
+/// Updates every trajectory agent once movement has run for the frame.
+UCLASS()
+class ROOICORE_API URGTrajectoryMassProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+
+	URGTrajectoryMassProcessor();
+
+	/// The per-agent update: records history, updates the motion estimate, predicts stop and pivot, and fills
+	/// in the prediction. Safe to call from any thread.
+	static void UpdateAgent(const FRGTrajectoryMassParameters& Parameters, double Time, const FTransform& Transform,
+		const FVector& Velocity, const FVector& DesiredVelocity, FRGTrajectoryMassHistoryFragment& History,
+		FRGTrajectoryMassStateFragment& State, FRGTrajectoryMassPredictionFragment& Prediction);
+
+protected:
+
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+
+	FMassEntityQuery EntityQuery;
+};
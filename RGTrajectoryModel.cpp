@@ -0,0 +1,82 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+#include "RGTrajectoryModel.h"
+
+void FRGTrajectoryModel::Initialize(const FRGTrajectoryModelInput& Input)
+{
+	StartRotation = Input.Rotation;
+
+	RGTrajectoryCore::FTrajectoryModelInput CoreInput;
+	CoreInput.Type = Input.Type;
+	CoreInput.Location = RGTrajectoryCore::ToCore(Input.Location);
+	CoreInput.Velocity = RGTrajectoryCore::ToCore(Input.Velocity);
+	CoreInput.Acceleration = RGTrajectoryCore::ToCore(Input.Acceleration);
+	CoreInput.YawRate = Input.YawRate;
+	CoreInput.YawRateDecay = Input.YawRateDecay;
+	CoreInput.BrakingDeceleration = Input.BrakingDeceleration;
+	CoreInput.Friction = Input.Friction;
+	CoreInput.MaxSpeed = Input.MaxSpeed;
+	CoreInput.Gravity = RGTrajectoryCore::ToCore(Input.Gravity);
+	CoreInput.AirControl = Input.AirControl;
+	CoreInput.bHasLandingHeight = Input.bHasLandingHeight;
+	CoreInput.LandingHeight = Input.LandingHeight;
+	CoreInput.Drag = Input.Drag;
+	CoreInput.Horizon = Input.Horizon;
+
+	Core.Initialize(CoreInput);
+}
+
+FVector FRGTrajectoryModel::GetLandingLocation() const
+{
+	return RGTrajectoryCore::ToEngine(Core.GetLandingLocation());
+}
+
+void FRGTrajectoryModel::Evaluate(float Seconds, FVector& OutLocation, FVector& OutVelocity, FRotator& OutRotation) const
+{
+	RGTrajectoryCore::FVec3 Location;
+	RGTrajectoryCore::FVec3 Velocity;
+	double YawDelta;
+	Core.Evaluate(Seconds, Location, Velocity, YawDelta);
+
+	OutLocation = RGTrajectoryCore::ToEngine(Location);
+	OutVelocity = RGTrajectoryCore::ToEngine(Velocity);
+	OutRotation = FRotator(StartRotation.Pitch, StartRotation.Yaw + YawDelta, StartRotation.Roll);
+}
+
+FRGMovementSample FRGTrajectoryModel::MakeSample(float Seconds, const FTransform& FromOrigin) const
+{
+	FVector Location;
+	FVector Velocity;
+	FRotator Rotation;
+	Evaluate(Seconds, Location, Velocity, Rotation);
+
+	const FTransform NewTransform = FTransform(Rotation.Quaternion(), Location);
+
+	FRGMovementSample Result;
+	Result.RelativeTransform = NewTransform.GetRelativeTransform(FromOrigin);
+	Result.RelativeLinearVelocity = FromOrigin.InverseTransformVectorNoScale(Velocity);
+	Result.WorldTransform = NewTransform;
+	Result.WorldLinearVelocity = Velocity;
+	Result.AccumulatedSeconds = Seconds;
+
+	return Result;
+}
+
+void FRGTrajectoryModel::MakeSamples(int32 Count, float TimePerSample, const FTransform& FromOrigin,
+	FRGMovementSample* OutSamples) const
+{
+	for (int32 Idx = 0; Idx < Count; Idx++)
+	{
+		OutSamples[Idx] = MakeSample(TimePerSample * (Idx + 1), FromOrigin);
+	}
+}
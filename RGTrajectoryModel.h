@@ -0,0 +1,111 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RGMovementSample.h"
+#include "RGTrajectoryCore.h"
+
+/// Conversions between engine vectors and the engine-independent core's.
+namespace RGTrajectoryCore
+{
+	FORCEINLINE FVec3 ToCore(const FVector& Vector) { return FVec3(Vector.X, Vector.Y, Vector.Z); }
+	FORCEINLINE FVector ToEngine(const FVec3& Vector) { return FVector(Vector.X, Vector.Y, Vector.Z); }
+}
+
+/// Starting state and movement parameters for an FRGTrajectoryModel.
+struct ROOICORE_API FRGTrajectoryModelInput
+{
+	ERGTrajectoryModelType Type { ERGTrajectoryModelType::Grounded };
+
+	FVector Location { 0.f };
+	FRotator Rotation { FRotator::ZeroRotator };
+	FVector Velocity { 0.f };
+	FVector Acceleration { 0.f };
+
+	/// Current turn rate, in degrees per second.
+	float YawRate { 0.f };
+
+	/// Exponential decay rate of the turn rate, per second. Zero means the turn rate is held constant.
+	float YawRateDecay { 0.f };
+
+	float BrakingDeceleration { 0.f };
+	float Friction { 0.f };
+	float MaxSpeed { 0.f };
+
+	/// Ballistic only: gravitational acceleration.
+	FVector Gravity { 0.f, 0.f, -980.f };
+
+	/// Ballistic only: the fraction of Acceleration which applies while in the air.
+	float AirControl { 0.f };
+
+	/// Ballistic only: if set, the world Z at which we'll consider ourselves landed.
+	bool bHasLandingHeight { false };
+	float LandingHeight { 0.f };
+
+	/// Drag only: how strongly the fluid resists movement, per second.
+	float Drag { 0.f };
+
+	/// The furthest time we expect to be asked about; only used to decide how many turn segments to build.
+	float Horizon { 1.f };
+};
+
+/// An analytic movement model. Rather than stepping a simulation forward sample by sample, the
+/// model is solved once in Initialize and can then be evaluated at any time offset in constant time.
+///
+/// For grounded movement, while accelerating, speed along the acceleration direction changes at a constant rate
+/// until it reaches MaxSpeed, and any speed across it decays under friction; the acceleration direction itself
+/// turns at the current yaw rate, which decays geometrically over time. The decaying turn is approximated by a
+/// handful of constant-rate segments, one per turn rate half-life, each of which has an exact closed-form
+/// solution. While braking, speed falls off under friction and braking deceleration along
+/// a straight line until the pawn stops.
+///
+/// The ballistic and drag models are simpler still, and solved directly in three dimensions.
+///
+/// The math lives in RGTrajectoryCore::FTrajectoryModel, which has no engine dependency; this wraps it.
+struct ROOICORE_API FRGTrajectoryModel
+{
+	static constexpr int32 MaxTurnSegments = RGTrajectoryCore::FTrajectoryModel::MaxTurnSegments;
+
+	void Initialize(const FRGTrajectoryModelInput& Input);
+
+	/// Evaluate the model at the given number of seconds in the future.
+	void Evaluate(float Seconds, FVector& OutLocation, FVector& OutVelocity, FRotator& OutRotation) const;
+
+	/// Evaluate the model and build a movement sample relative to the given origin.
+	FRGMovementSample MakeSample(float Seconds, const FTransform& FromOrigin) const;
+
+	/// Fill Count samples, evenly spaced TimePerSample apart starting one step in.
+	void MakeSamples(int32 Count, float TimePerSample, const FTransform& FromOrigin, FRGMovementSample* OutSamples) const;
+
+	/// If braking, how long until we come to a complete stop. Negative if we never stop (or aren't braking).
+	float GetStopTime() const { return Core.GetStopTime(); }
+
+	bool IsAccelerating() const { return Core.IsAccelerating(); }
+
+	/// Ballistic only: the time until we reach the landing height. Negative if we never will.
+	float GetLandingTime() const { return Core.GetLandingTime(); }
+
+	/// Ballistic only: where we'll be when we land. Only valid if GetLandingTime is non-negative.
+	FVector GetLandingLocation() const;
+
+	ERGTrajectoryModelType GetType() const { return Core.GetType(); }
+
+private:
+
+	/// The model itself; we only convert to and from engine types.
+	RGTrajectoryCore::FTrajectoryModel Core;
+
+	/// Pitch and roll are held; the model only turns yaw.
+	FRotator StartRotation { FRotator::ZeroRotator };
+};
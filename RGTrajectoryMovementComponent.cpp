@@ -11,10 +11,41 @@
  */
 
 #include "RGTrajectoryMovementComponent.h"
+#include "RGRagdollTracking.h"
+#include "RGTrajectoryMass.h"
+#include "RGTrajectorySubsystem.h"
+#include "Animation/AnimInstance.h"
+#include "AIController.h"
+#include "Animation/AnimMontage.h"
+#include "Components/SplineComponent.h"
 #include "GeometryCollection/GeometryCollectionSimulationTypes.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/KismetSystemLibrary.h"
+#include "NavigationData.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "PBDRigidsSolver.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+#include "PhysicsEngine/SkeletalBodySetup.h"
+
+static TAutoConsoleVariable<int32> CVarMaxPredictionSweepsPerFrame(
+	TEXT("rg.Trajectory.MaxPredictionSweepsPerFrame"),
+	64,
+	TEXT("Maximum number of asynchronous prediction sweeps issued per frame, across all trajectory components."));
+
+namespace RGTrajectory
+{
+	// Global sweep budget bookkeeping; only touched on the game thread.
+	static uint64 PredictionSweepBudgetFrame = 0;
+	static int32 PredictionSweepsThisFrame = 0;
+
+	// Hits with a normal steeper than this are treated as floor, not as something blocking the path.
+	static constexpr float WalkableNormalZ = 0.7f;
 
+	// Shrink the swept shape slightly so that the floor we're standing on doesn't register as a hit.
+	static constexpr float PredictionSweepInflation = -5.f;
+}
 
 // Sets default values for this component's properties
 URGTrajectoryMovementComponent::URGTrajectoryMovementComponent()
@@ -23,7 +54,9 @@ URGTrajectoryMovementComponent::URGTrajectoryMovementComponent()
 	// off to improve performance if you don't need them.
 	PrimaryComponentTick.bCanEverTick = true;
 
-	// ...
+	TrajectoryTick.bCanEverTick = true;
+	TrajectoryTick.bStartWithTickEnabled = true;
+	TrajectoryTick.TickGroup = TG_PrePhysics;
 }
 
 
@@ -32,8 +65,115 @@ void URGTrajectoryMovementComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// ...
-	
+	PredictionSweepDelegate.BindUObject(this, &URGTrajectoryMovementComponent::OnPredictionSweepComplete);
+	RagdollFloorTraceDelegate.BindUObject(this, &URGTrajectoryMovementComponent::OnRagdollFloorTraceComplete);
+
+	// Animation reads our results, so make sure they're in before the mesh ticks.
+	if (IsValid(SkeletalMesh) && TrajectoryTick.IsTickFunctionRegistered())
+	{
+		SkeletalMesh->PrimaryComponentTick.AddPrerequisite(this, TrajectoryTick);
+	}
+
+	CacheRagdollBodies();
+
+	const int32 HistoryCapacity = FMath::Max(MaxTrajectorySamples, 1);
+	if (URGTrajectorySubsystem* Subsystem = GetWorld()->GetSubsystem<URGTrajectorySubsystem>())
+	{
+		Subsystem->RegisterTrajectoryComponent(this);
+
+		for (const UAnimMontage* Montage : PrebakedRootMotionMontages)
+		{
+			Subsystem->FindOrBakeRootMotionTable(Montage);
+		}
+
+		// Keep our history in the shared arena if it'll fit in a slot.
+		HistorySlotClass = URGTrajectorySubsystem::GetHistorySlotClass(HistoryCapacity);
+		if (HistorySlotClass != INDEX_NONE)
+		{
+			HistorySlot = Subsystem->AcquireHistorySlot(HistorySlotClass);
+			MovementHistory.AttachStorage(Subsystem->GetHistorySlotData(HistorySlotClass, HistorySlot), HistoryCapacity);
+		}
+		else
+		{
+			UE_LOG(LogRGTrajectory, Warning, TEXT("%s: MaxTrajectorySamples (%d) is larger than the biggest shared history slot (%d); falling back to a separate allocation."),
+				*GetPathName(), HistoryCapacity, URGTrajectorySubsystem::GetHistorySlotCapacity(URGTrajectorySubsystem::NumHistorySlotClasses - 1));
+		}
+	}
+
+	if (!MovementHistory.HasExternalStorage())
+	{
+		MovementHistory.SetCapacity(HistoryCapacity);
+	}
+
+	if (LongHistorySeconds > 0.f)
+	{
+		LongHistory.SetCapacity(MaxLongHistoryKeyframes);
+		LongHistory.PositionTolerance = LongHistoryPositionTolerance;
+		LongHistory.RotationTolerance = LongHistoryRotationTolerance;
+	}
+}
+
+void URGTrajectoryMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (URGTrajectorySubsystem* Subsystem = GetWorld()->GetSubsystem<URGTrajectorySubsystem>())
+	{
+		Subsystem->UnregisterTrajectoryComponent(this);
+		Subsystem->DequeueRagdollTransition(this);
+
+		if (HistorySlot != INDEX_NONE)
+		{
+			MovementHistory.DetachStorage();
+			Subsystem->ReleaseHistorySlot(HistorySlotClass, HistorySlot);
+		}
+	}
+	HistorySlot = INDEX_NONE;
+	HistorySlotClass = INDEX_NONE;
+	bRagdollTransitionQueued = false;
+	CancelRagdollFloorTrace();
+	StopRagdollTracking();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void URGTrajectoryMovementComponent::RegisterComponentTickFunctions(bool bRegister)
+{
+	Super::RegisterComponentTickFunctions(bRegister);
+
+	if (bRegister)
+	{
+		// A Blueprint override of UpdateMovementSamples can't be run off the game thread.
+		static const FName UpdateMovementSamplesName = GET_FUNCTION_NAME_CHECKED(URGTrajectoryMovementComponent, UpdateMovementSamples);
+		TrajectoryTick.bRunOnAnyThread = bTrajectoryTickOnAnyThread && !GetClass()->IsFunctionImplementedInScript(UpdateMovementSamplesName);
+
+		if (SetupActorComponentTickFunction(&TrajectoryTick))
+		{
+			TrajectoryTick.Target = this;
+			TrajectoryTick.AddPrerequisite(this, PrimaryComponentTick);
+		}
+	}
+	else if (TrajectoryTick.IsTickFunctionRegistered())
+	{
+		TrajectoryTick.UnRegisterTickFunction();
+	}
+}
+
+void FRGTrajectoryTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread,
+	const FGraphEventRef& MyCompletionGraphEvent)
+{
+	FActorComponentTickFunction::ExecuteTickHelper(Target, false, DeltaTime, TickType, [this](float DilatedTime)
+	{
+		Target->TickTrajectory(DilatedTime);
+	});
+}
+
+FString FRGTrajectoryTickFunction::DiagnosticMessage()
+{
+	return Target ? Target->GetFullName() + TEXT("[TickTrajectory]") : TEXT("<NULL>[TickTrajectory]");
+}
+
+FName FRGTrajectoryTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return Target ? FName(Target->GetClass()->GetName()) : NAME_None;
 }
 
 void URGTrajectoryMovementComponent::BindReplicationData_Implementation()
@@ -79,70 +219,247 @@ void URGTrajectoryMovementComponent::TickComponent(float DeltaTime, ELevelTick T
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	if (bResetMesh)
+	if (!bRagdollTransitionQueued && (bResetMesh || bRagdollReattachPending || (bFirstRagdollTick && GetMovementMode() == GetRagdollMode())))
 	{
-		UPrimitiveComponent* CollisionComponent = Cast<UPrimitiveComponent>(UpdatedComponent);
-		if (IsValid(CollisionComponent))
+		// Ragdoll transitions are expensive, so they're metered out by the subsystem rather than all happening
+		// on the same frame; until ours comes up, the mesh just keeps doing what it was doing.
+		URGTrajectorySubsystem* Subsystem = GetWorld()->GetSubsystem<URGTrajectorySubsystem>();
+		if (IsValid(Subsystem))
+		{
+			bRagdollTransitionQueued = true;
+			Subsystem->QueueRagdollTransition(this);
+		}
+		else
 		{
-			CollisionComponent->SetCollisionEnabled(ECollisionEnabled::Type::QueryAndPhysics);
-			SetRootCollisionHalfHeight(PreviousCollisionHalfHeight, true, false);
+			ProcessRagdollTransition();
 		}
+	}
 
-		SkeletalMesh->SetAllBodiesSimulatePhysics(false);
-		SkeletalMesh->ResetAllBodiesSimulatePhysics();
-		SkeletalMesh->AttachToComponent(GetPawnOwner()->GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform);
-		SkeletalMesh->SetRelativeLocationAndRotation(PreviousRelativeMeshLocation, PreviousRelativeMeshRotation, false, nullptr, ETeleportType::ResetPhysics);
-		bResetMesh = false;
+	if (RagdollTrackingCallback)
+	{
+		UpdateRagdollTracking();
 	}
-	else if (bFirstRagdollTick && GetMovementMode() == GetRagdollMode())
+	
+	if (bHadInput && !IsInputPresent())
 	{
-		bFirstRagdollTick = false;
+		InputStoppedAt = GetTime();
+	}
+	bHadInput = IsInputPresent();
 
-		if (bDrawDebugPredictions)
-		{
-			const FVector InitialActor = GetLinearVelocity_GMC();
-			const FVector InitialPhysics = SkeletalMesh->GetBoneLinearVelocity(FName(TEXT("root")));
-			DrawDebugLine(GetWorld(), GetActorLocation_GMC(), GetActorLocation_GMC() + RagdollLinearVelocity, FColor::Red, false, 1.f, 0, 2.f);
-		}
+	// Sweeps have to be issued from the game thread, so they cover the previous tick's prediction; the
+	// trajectory tick clips against whatever they found.
+	if (bCollisionAwarePrediction && GetMovementMode() != GetRagdollMode())
+	{
+		IssuePredictionSweeps();
+	}
+	else
+	{
+		PredictionBlock = FPredictionBlock();
+	}
 
-		UPrimitiveComponent* CollisionComponent = Cast<UPrimitiveComponent>(UpdatedComponent);
-		if (IsValid(CollisionComponent))
+	// A jump well beyond what our velocity could account for is a teleport; re-anchor rather than leaving a streak
+	// through the history.
+	if (HistoryTeleportDistance > 0.f && !MovementHistory.IsEmpty())
+	{
+		const FTransform CurrentTransform = GetPawnOwner()->GetActorTransform();
+		const FVector ExpectedLocation = TrajectorySnapshot.ActorTransform.GetLocation() + TrajectorySnapshot.LinearVelocity * DeltaTime;
+		if (FVector::DistSquared(CurrentTransform.GetLocation(), ExpectedLocation) > FMath::Square(HistoryTeleportDistance))
 		{
-			CollisionComponent->SetCollisionEnabled(ECollisionEnabled::Type::NoCollision);
+			ReanchorHistory(TrajectorySnapshot.ActorTransform, CurrentTransform, bCarryHistoryOnTeleport);
 		}
-		
-		PreviousCollisionHalfHeight = GetRootCollisionHalfHeight(true);
-		SetRootCollisionHalfHeight(0.1f, false, false);
+	}
 
-		SkeletalMesh->SetAllBodiesBelowSimulatePhysics(FName(TEXT("pelvis")), true, true);
-		SkeletalMesh->SetAllBodiesBelowLinearVelocity(FName(TEXT("pelvis")), RagdollLinearVelocity, true);
-		
+	if (bAdaptiveProxyUpdates && GetOwnerRole() == ROLE_Authority && !IsNetMode(NM_Standalone))
+	{
+		CheckProxyExtrapolation();
 	}
-	
-	if (bHadInput && !IsInputPresent())
+
+	CaptureTrajectorySnapshot();
+
+	if (!TrajectoryTick.IsTickFunctionRegistered())
 	{
-		InputStoppedAt = GetTime();
+		TickTrajectory(DeltaTime);
 	}
-	bHadInput = IsInputPresent();
+}
 
-	if (GetMovementMode() == EGMC_MovementMode::Grounded)
+void URGTrajectoryMovementComponent::CaptureMotionSnapshot()
+{
+	FRGTrajectorySnapshot& Snapshot = TrajectorySnapshot;
+	Snapshot.Time = GetTime();
+	Snapshot.ActorTransform = GetPawnOwner()->GetActorTransform();
+	Snapshot.LowerBound = GetLowerBound();
+	Snapshot.LinearVelocity = GetLinearVelocity_GMC();
+	Snapshot.MovementMode = GetMovementMode();
+}
+
+void URGTrajectoryMovementComponent::CaptureTrajectorySnapshot()
+{
+	CaptureMotionSnapshot();
+
+	FRGTrajectorySnapshot& Snapshot = TrajectorySnapshot;
+	Snapshot.bInputPresent = IsInputPresent();
+	Snapshot.bInputPresentWithGrace = IsInputPresent(true);
+	Snapshot.bInputAndVelocityDiffer = DoInputAndVelocityDiffer();
+	Snapshot.InputVelocityOffset = InputVelocityOffsetAngle();
+	Snapshot.EffectiveAcceleration = GetCurrentEffectiveAcceleration();
+
+	// Proxies don't receive the input vector itself, only its angle from our velocity.
+	Snapshot.InputDirection = IsSimulatedProxy() ?
+		Snapshot.LinearVelocity.GetSafeNormal2D().RotateAngleAxis(Snapshot.InputVelocityOffset, FVector::UpVector) :
+		GetProcessedInputVector().GetSafeNormal2D();
+
+	Snapshot.BrakingDeceleration = GetBrakingDeceleration();
+	Snapshot.GroundFriction = GroundFriction;
+	Snapshot.MaxSpeed = GetMaxSpeed();
+	Snapshot.GravityZ = GetGravityZ();
+
+	Snapshot.RootMotionTable.Reset();
+	if (bPredictRootMotion && IsValid(SkeletalMesh))
 	{
-		if (bPrecalculateDistanceMatches)
+		const UAnimInstance* AnimInstance = SkeletalMesh->GetAnimInstance();
+		const FAnimMontageInstance* MontageInstance = AnimInstance ? AnimInstance->GetRootMotionMontageInstance() : nullptr;
+		URGTrajectorySubsystem* Subsystem = GetWorld()->GetSubsystem<URGTrajectorySubsystem>();
+
+		// A paused or reversed montage can't be looked ahead along; leave those to the movement model.
+		if (MontageInstance && Subsystem && MontageInstance->IsPlaying() && MontageInstance->GetPlayRate() > UE_KINDA_SMALL_NUMBER)
 		{
-			UpdateStopPrediction();
-			UpdatePivotPrediction();
+			Snapshot.RootMotionTable = Subsystem->FindOrBakeRootMotionTable(MontageInstance->Montage);
+			Snapshot.RootMotionPosition = MontageInstance->GetPosition();
+			Snapshot.RootMotionPlayRate = MontageInstance->GetPlayRate();
+			Snapshot.RootMotionMeshTransform = FTransform(Snapshot.ActorTransform.GetRotation().Inverse() * SkeletalMesh->GetComponentQuat(),
+				FVector::ZeroVector, SkeletalMesh->GetComponentScale());
 		}
+	}
+
+	UpdatePredictionPath(Snapshot);
+}
+
+void URGTrajectoryMovementComponent::SetPredictionPath(const TArray<FVector>& Points)
+{
+	TSharedPtr<FRGTrajectoryPath> Path = MakeShared<FRGTrajectoryPath>();
+	Path->SetPoints(Points);
+	ExplicitPredictionPath = Path;
+}
+
+void URGTrajectoryMovementComponent::SetPredictionPathFromSpline(const USplineComponent* Spline, float Tolerance)
+{
+	if (!IsValid(Spline))
+	{
+		ClearPredictionPath();
+		return;
+	}
+
+	TArray<FVector> Points;
+	Spline->ConvertSplineToPolyLine(ESplineCoordinateSpace::World, FMath::Square(FMath::Max(Tolerance, 0.1f)), Points);
+	SetPredictionPath(Points);
+}
 
-		if (bTrajectoryEnabled)
+void URGTrajectoryMovementComponent::ClearPredictionPath()
+{
+	ExplicitPredictionPath.Reset();
+}
+
+void URGTrajectoryMovementComponent::UpdatePredictionPath(FRGTrajectorySnapshot& Snapshot)
+{
+	Snapshot.Path.Reset();
+
+	TSharedPtr<const FRGTrajectoryPath> Path = ExplicitPredictionPath;
+	if (!Path.IsValid() && bPredictAlongNavigationPath)
+	{
+		const AAIController* Controller = Cast<AAIController>(GetPawnOwner()->GetController());
+		const UPathFollowingComponent* PathFollowing = Controller ? Controller->GetPathFollowingComponent() : nullptr;
+		const FNavPathSharedPtr NavPath = PathFollowing && PathFollowing->GetStatus() == EPathFollowingStatus::Moving ? PathFollowing->GetPath() : FNavPathSharedPtr();
+
+		if (NavPath.IsValid() && NavPath->IsValid())
 		{
-			UpdateMovementSamples();
-			if (bPrecalculateFutureTrajectory)
+			// Only copy the navigation path when it's replaced or repathed.
+			if (!CachedNavigationPath.HasSameObject(NavPath.Get()) || NavPath->GetTimeStamp() != CachedNavigationPathTimeStamp)
 			{
-				UpdateTrajectoryPrediction();
+				TArray<FVector, TInlineAllocator<32>> Points;
+				for (const FNavPathPoint& Point : NavPath->GetPathPoints())
+				{
+					Points.Add(Point.Location);
+				}
+
+				TSharedPtr<FRGTrajectoryPath> NewPath = MakeShared<FRGTrajectoryPath>();
+				NewPath->SetPoints(Points);
+				NavigationPredictionPath = NewPath;
+				CachedNavigationPath = NavPath;
+				CachedNavigationPathTimeStamp = NavPath->GetTimeStamp();
 			}
+
+			Path = NavigationPredictionPath;
+		}
+		else
+		{
+			NavigationPredictionPath.Reset();
+			CachedNavigationPath.Reset();
 		}
 	}
-	else
+
+	if (!Path.IsValid() || !Path->IsValid() || Snapshot.MovementMode != EGMC_MovementMode::Grounded)
+	{
+		ProfiledPath.Reset();
+		return;
+	}
+
+	const bool bNewPath = Path != ProfiledPath;
+	if (bNewPath)
+	{
+		PathSegmentHint = 0;
+	}
+
+	const double Distance = Path->Project(Snapshot.ActorTransform.GetLocation(), PathSegmentHint);
+
+	int32 Segment = PathSegmentHint;
+	FVector Direction;
+	Path->Evaluate(Distance, Direction, Segment);
+	const double Speed = FMath::Max(Snapshot.LinearVelocity | Direction, 0.0);
+
+	// The profile holds for as long as the pawn keeps to it; only rebuild it if something's changed.
+	double ExpectedDistance;
+	double ExpectedSpeed;
+	PathProfile.Evaluate(Snapshot.Time - PathProfileStartTime, ExpectedDistance, ExpectedSpeed);
+
+	if (bNewPath || Snapshot.MaxSpeed != PathProfileMaxSpeed ||
+		FMath::Abs(PathProfileStartDistance + ExpectedDistance - Distance) > PathProfileDistanceTolerance ||
+		FMath::Abs(ExpectedSpeed - Speed) > PathProfileSpeedTolerance)
+	{
+		// A pawn handed a path while standing still isn't accelerating yet, but it's about to; as in
+		// BuildTrajectoryModelInput, assume full acceleration rather than a profile which never gets going.
+		const double AccelerationSize = Snapshot.EffectiveAcceleration.Size2D();
+		PathProfile.Initialize(Speed, AccelerationSize > UE_KINDA_SMALL_NUMBER ? AccelerationSize : TrajectoryMaxAcceleration,
+			Snapshot.MaxSpeed, Snapshot.BrakingDeceleration, Snapshot.GroundFriction, Path->GetLength() - Distance);
+		ProfiledPath = Path;
+		PathProfileStartTime = Snapshot.Time;
+		PathProfileStartDistance = Distance;
+		PathProfileMaxSpeed = Snapshot.MaxSpeed;
+	}
+
+	Snapshot.Path = Path;
+	Snapshot.PathDistance = Distance;
+	Snapshot.PathSegment = PathSegmentHint;
+	Snapshot.PathProfile = PathProfile;
+	Snapshot.PathProfileSeconds = Snapshot.Time - PathProfileStartTime;
+}
+
+void URGTrajectoryMovementComponent::TickTrajectory(float DeltaTime)
+{
+	const bool bGrounded = TrajectorySnapshot.MovementMode == EGMC_MovementMode::Grounded;
+	const bool bRagdoll = TrajectorySnapshot.MovementMode == GetRagdollMode();
+
+	if (bGrounded)
+	{
+		LastGroundedHeight = TrajectorySnapshot.ActorTransform.GetLocation().Z;
+		bHasGroundedHeight = true;
+	}
+
+	if (bGrounded && bPrecalculateDistanceMatches)
+	{
+		UpdateStopPrediction();
+		UpdatePivotPrediction();
+	}
+	else if (!bGrounded)
 	{
 		bTrajectoryIsPivoting = false;
 		bTrajectoryIsStopping = false;
@@ -153,41 +470,130 @@ void URGTrajectoryMovementComponent::TickComponent(float DeltaTime, ELevelTick T
 		bDebugHadPreviousPivot = false;
 		bDebugHadPreviousStop = false;
 #endif
-		
 	}
 
-#if ENABLE_DRAW_DEBUG || WITH_EDITORONLY_DATA
-	if (IsTrajectoryDebugEnabled() && !IsNetworkedServer() && GetMovementMode() == EGMC_MovementMode::Grounded)
+	if (!bRagdoll && bPrecalculateDistanceMatches)
+	{
+		UpdateLandingPrediction();
+	}
+	else
+	{
+		bTrajectoryIsLanding = false;
+	}
+
+	// History is kept in every movement mode, so that there are no gaps across jumps and the like; the
+	// ragdoll is driven by physics rather than by us, so it has nothing useful to predict.
+	if (bTrajectoryEnabled)
+	{
+		if (TrajectoryTick.bRunOnAnyThread)
+		{
+			// Not overridden in Blueprint (see RegisterComponentTickFunctions), so skip the event dispatch.
+			UpdateMovementSamples_Implementation();
+		}
+		else
+		{
+			UpdateMovementSamples();
+		}
+
+		if (bPrecalculateFutureTrajectory)
+		{
+			if (bRagdoll)
+			{
+				PredictedTrajectory.Samples.Reset();
+				AppendMovementHistory(PredictedTrajectory.Samples, false);
+				PredictionRevision++;
+			}
+			else
+			{
+				UpdateTrajectoryPrediction();
+			}
+		}
+	}
+
+	if (bCollisionAwarePrediction && !bRagdoll)
+	{
+		ApplyPredictionCollision();
+	}
+
+	UpdateTrajectoryAnimData();
+	DetectTrajectoryEvents();
+
+	// Off the game thread, the subsystem dispatches these for us when it ticks at the end of the frame.
+	if (IsInGameThread())
+	{
+		DispatchTrajectoryEvents();
+	}
+}
+
+void URGTrajectoryMovementComponent::DetectTrajectoryEvents()
+{
+	const FRGTrajectorySnapshot& Snapshot = TrajectorySnapshot;
+
+	auto QueueEvent = [this](ERGTrajectoryEvent Event, const FVector& Point = FVector::ZeroVector, float Seconds = 0.f)
+	{
+		FRGTrajectoryEventData& Data = PendingTrajectoryEvents.AddDefaulted_GetRef();
+		Data.Event = Event;
+		Data.Point = Point;
+		Data.Seconds = Seconds;
+	};
+
+	if (bTrajectoryIsStopping != bEventWasStopping)
 	{
-		const FVector ActorLocation = GetActorLocation_GMC();
-		if (bTrajectoryIsStopping || (bDebugHadPreviousStop && GetLinearVelocity_GMC().IsZero()))
+		bEventWasStopping = bTrajectoryIsStopping;
+		if (bTrajectoryIsStopping)
 		{
-			if (bTrajectoryIsStopping) DebugPreviousStop = ActorLocation + PredictedStopPoint;
-			DrawDebugSphere(GetWorld(), DebugPreviousStop, 24.f, 12, bTrajectoryIsStopping ? FColor::Blue : FColor::Black, false, bTrajectoryIsStopping ? -1 : 1.f, 0, bTrajectoryIsStopping ? 1.f: 2.f);
-			bDebugHadPreviousStop = bTrajectoryIsStopping;
+			QueueEvent(ERGTrajectoryEvent::StopBegin, PredictedStopPoint, PredictedStopSeconds);
 		}
-		
-		if (bTrajectoryIsPivoting || (bDebugHadPreviousPivot && !DoInputAndVelocityDiffer()))
+		else
 		{
-			if (bTrajectoryIsPivoting) DebugPreviousPivot = ActorLocation + PredictedPivotPoint;
-			DrawDebugSphere(GetWorld(), DebugPreviousPivot, 24.f, 12, bTrajectoryIsPivoting ? FColor::Yellow : FColor::White, false, bTrajectoryIsPivoting ? -1 : 2.f, 0, bTrajectoryIsPivoting ? 1.f : 2.f);
-			bDebugHadPreviousPivot = bTrajectoryIsPivoting;
+			QueueEvent(ERGTrajectoryEvent::StopEnd);
 		}
+	}
 
-		if (DoInputAndVelocityDiffer())
+	if (bTrajectoryIsPivoting != bEventWasPivoting)
+	{
+		bEventWasPivoting = bTrajectoryIsPivoting;
+		if (bTrajectoryIsPivoting)
 		{
-			const FVector LinearVelocityDirection = GetLinearVelocity_GMC().GetSafeNormal();
-			const FVector AccelerationDirection = UKismetMathLibrary::RotateAngleAxis(LinearVelocityDirection, InputVelocityOffsetAngle(), FVector(0.f, 0.f, 1.f));
-			DrawDebugLine(GetWorld(), ActorLocation, ActorLocation + (AccelerationDirection * 120.f), FColor::Yellow, false, -1, 0, 2.f);
+			QueueEvent(ERGTrajectoryEvent::PivotBegin, PredictedPivotPoint, PredictedPivotSeconds);
 		}
-		
-		if (bTrajectoryEnabled)
+		else
 		{
-			PredictedTrajectory.DrawDebug(GetWorld(), GetPawnOwner()->GetActorTransform());
+			QueueEvent(ERGTrajectoryEvent::PivotEnd);
 		}
 	}
-#endif
-	
+
+	const bool bMoving = !Snapshot.LinearVelocity.IsNearlyZero();
+	if (bMoving != bEventWasMoving)
+	{
+		bEventWasMoving = bMoving;
+		if (bMoving)
+		{
+			QueueEvent(ERGTrajectoryEvent::StartMoving);
+		}
+	}
+
+	if (Snapshot.bInputPresent != bEventHadInput)
+	{
+		bEventHadInput = Snapshot.bInputPresent;
+		QueueEvent(Snapshot.bInputPresent ? ERGTrajectoryEvent::InputStarted : ERGTrajectoryEvent::InputStopped);
+	}
+}
+
+void URGTrajectoryMovementComponent::DispatchTrajectoryEvents()
+{
+	check(IsInGameThread());
+	if (PendingTrajectoryEvents.IsEmpty()) return;
+
+	// Handlers may well change our state, so broadcast from a copy.
+	const TArray<FRGTrajectoryEventData, TInlineAllocator<4>> Events = MoveTemp(PendingTrajectoryEvents);
+	PendingTrajectoryEvents.Reset();
+
+	for (const FRGTrajectoryEventData& Event : Events)
+	{
+		OnTrajectoryEventNative.Broadcast(this, Event);
+		OnTrajectoryEvent.Broadcast(Event);
+	}
 }
 
 void URGTrajectoryMovementComponent::MovementUpdate_Implementation(float DeltaSeconds)
@@ -205,6 +611,34 @@ void URGTrajectoryMovementComponent::MovementUpdate_Implementation(float DeltaSe
 	{
 		UpdateCalculatedEffectiveAcceleration();
 	}
+	else
+	{
+		// GetTime reports the time of the move being processed, so if it goes backwards GMC is replaying moves after
+		// a correction; whatever history we recorded past that point is invalid, and the replay re-records it.
+		const double MoveTime = GetTime();
+		if (MoveTime < LastMoveTime)
+		{
+			ReplayUntilTime = FMath::Max(ReplayUntilTime, LastMoveTime);
+			RewindHistoryTo(MoveTime);
+		}
+		LastMoveTime = MoveTime;
+
+		if (ReplayUntilTime >= 0.0)
+		{
+			// Only re-record the history; the path and prediction state belong to the present, and are left for
+			// the next normal tick to bring up to date.
+			if (bTrajectoryEnabled)
+			{
+				CaptureMotionSnapshot();
+				AddNewMovementSample(GetMovementSampleFromCurrentState());
+			}
+
+			if (MoveTime >= ReplayUntilTime)
+			{
+				ReplayUntilTime = -1.0;
+			}
+		}
+	}
 	
 }
 
@@ -214,6 +648,11 @@ void URGTrajectoryMovementComponent::GenSimulationTick_Implementation(float Delt
 
 	if (GetMovementMode() == EGMC_MovementMode::Grounded)
 		UpdateCalculatedEffectiveAcceleration();
+
+	if (bAdaptiveProxyUpdates && IsSimulatedProxy())
+	{
+		ApplyProxyExtrapolation(DeltaTime);
+	}
 }
 
 bool URGTrajectoryMovementComponent::UpdateMovementModeDynamic_Implementation(FGMC_FloorParams& Floor,
@@ -280,39 +719,17 @@ bool URGTrajectoryMovementComponent::CanMove_Implementation() const
 
 float URGTrajectoryMovementComponent::GetAngleDifferenceXY(const FVector& A, const FVector& B)
 {
-	const FVector XY=FVector(1.f, 1.f, 0.f);
-	const FVector AXY = A * XY;
-	const FVector BXY = B * XY;
-	
-	float Angle = GetAngleDifference(AXY, BXY);
-	const FVector Cross = FVector::CrossProduct(AXY, BXY);
-	Angle *= Cross.Z > 0.f ? 1.f : -1.f;
-	return Angle;
+	return RGTrajectoryCore::AngleDifferenceXY(RGTrajectoryCore::ToCore(A), RGTrajectoryCore::ToCore(B));
 }
 
 float URGTrajectoryMovementComponent::GetAngleDifferenceZ(const FVector& A, const FVector& B)
 {
-	const FVector Z=FVector(0.f, 0.f, 1.f);
-	const FVector AZ = A * Z;
-	const FVector BZ = B * Z;
-
-	float Angle = GetAngleDifference(AZ, BZ);
-	const FVector Cross = FVector::CrossProduct(AZ, BZ);
-	Angle *= Cross.Y > 0.f ? 1.f : -1.f;
-
-	return Angle;
+	return RGTrajectoryCore::AngleDifferenceZ(RGTrajectoryCore::ToCore(A), RGTrajectoryCore::ToCore(B));
 }
 
 float URGTrajectoryMovementComponent::GetAngleDifference(const FVector& A, const FVector& B)
 {
-	const FVector ANorm = A.GetSafeNormal();
-	const FVector BNorm = B.GetSafeNormal();
-
-	// Why waste time on math if they're identical?
-	if (ANorm == BNorm) return 0.f;
-
-	const float DotProduct = FVector::DotProduct(ANorm, BNorm);
-	return (180.0)/UE_DOUBLE_PI * FMath::Acos(DotProduct);
+	return RGTrajectoryCore::AngleDifference(RGTrajectoryCore::ToCore(A), RGTrajectoryCore::ToCore(B));
 }
 
 
@@ -332,47 +749,249 @@ bool URGTrajectoryMovementComponent::IsTrajectoryDebugEnabled() const
 #endif
 }
 
-bool URGTrajectoryMovementComponent::IsInputPresent(bool bAllowGrace) const
+#if ENABLE_DRAW_DEBUG || WITH_EDITORONLY_DATA
+namespace
 {
-	if (IsSimulatedProxy() && bAllowGrace)
+	void AppendDebugMarker(TArray<FBatchedLine>& OutLines, const FVector& Location, const FLinearColor& Color, float Thickness)
 	{
-		return bInputPresent || (GetTime() - InputStoppedAt < 0.01);
-	}
+		constexpr int32 Segments = 8;
+		constexpr float Radius = 24.f;
 
-	return bInputPresent;
+		FVector Previous = Location + FVector(Radius, 0.f, 0.f);
+		for (int32 Idx = 1; Idx <= Segments; Idx++)
+		{
+			const float Angle = UE_TWO_PI * Idx / Segments;
+			const FVector Next = Location + FVector(FMath::Cos(Angle) * Radius, FMath::Sin(Angle) * Radius, 0.f);
+			OutLines.Emplace(Previous, Next, Color, 0.f, Thickness, SDPG_World);
+			Previous = Next;
+		}
+		OutLines.Emplace(Location - FVector(0.f, 0.f, Radius), Location + FVector(0.f, 0.f, Radius), Color, 0.f, Thickness, SDPG_World);
+	}
 }
 
-void URGTrajectoryMovementComponent::UpdateCalculatedEffectiveAcceleration()
+void URGTrajectoryMovementComponent::AppendDebugLines(TArray<FBatchedLine>& OutLines, int32 SampleStride)
 {
-	if (GetLinearVelocity_GMC().IsZero())
+	if (IsNetworkedServer()) return;
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const FVector ActorLocation = GetActorLocation_GMC();
+	
+	if (bTrajectoryIsStopping || (bDebugHadPreviousStop && GetLinearVelocity_GMC().IsZero()))
 	{
-		CalculatedEffectiveAcceleration = FVector::ZeroVector;
+		if (bTrajectoryIsStopping)
+		{
+			DebugPreviousStop = ActorLocation + PredictedStopPoint;
+			AppendDebugMarker(OutLines, DebugPreviousStop, FColor::Blue, 1.f);
+		}
+		else
+		{
+			DebugStopMarkerExpiry = Now + 1.0;
+		}
+		bDebugHadPreviousStop = bTrajectoryIsStopping;
 	}
-	
-	const int32 Idx = GetCurrentMoveHistoryNum();
-	if (Idx < 1) return;
 
-	const double SyncedTime = GetTime();
-	
-	const FGMC_Move LastMove = AccessMoveHistory(Idx - 1);
-	if (!LastMove.HasValidTimestamp() || LastMove.MetaData.Timestamp == SyncedTime) return;
+	if (Now < DebugStopMarkerExpiry)
+	{
+		AppendDebugMarker(OutLines, DebugPreviousStop, FColor::Black, 2.f);
+	}
 
-	const FVector DeltaV = GetLinearVelocity_GMC() - GetLinearVelocityFromState(LastMove.OutputState);
-	CalculatedEffectiveAcceleration = -DeltaV / (SyncedTime - LastMove.MetaData.Timestamp);
-}
+	if (bTrajectoryIsPivoting || (bDebugHadPreviousPivot && !DoInputAndVelocityDiffer()))
+	{
+		if (bTrajectoryIsPivoting)
+		{
+			DebugPreviousPivot = ActorLocation + PredictedPivotPoint;
+			AppendDebugMarker(OutLines, DebugPreviousPivot, FColor::Yellow, 1.f);
+		}
+		else
+		{
+			DebugPivotMarkerExpiry = Now + 2.0;
+		}
+		bDebugHadPreviousPivot = bTrajectoryIsPivoting;
+	}
 
-void URGTrajectoryMovementComponent::UpdateStopPrediction()
-{
-	PredictedStopPoint = PredictGroundedStopLocation(GetLinearVelocity_GMC(), GetBrakingDeceleration(), GroundFriction);
-	bTrajectoryIsStopping = !PredictedStopPoint.IsZero() && !IsInputPresent();
+	if (Now < DebugPivotMarkerExpiry)
+	{
+		AppendDebugMarker(OutLines, DebugPreviousPivot, FColor::White, 2.f);
+	}
+
+	if (bTrajectoryIsLanding)
+	{
+		AppendDebugMarker(OutLines, ActorLocation + PredictedLandingPoint, FColor::Green, 1.f);
+	}
+
+	if (Now < DebugRagdollLaunchMarkerExpiry)
+	{
+		OutLines.Emplace(DebugRagdollLaunchStart, DebugRagdollLaunchStart + RagdollLinearVelocity, FColor::Red, 0.f, 2.f, SDPG_World);
+	}
+
+	if (DoInputAndVelocityDiffer() && GetMovementMode() == EGMC_MovementMode::Grounded)
+	{
+		const FVector LinearVelocityDirection = GetLinearVelocity_GMC().GetSafeNormal();
+		const FVector AccelerationDirection = UKismetMathLibrary::RotateAngleAxis(LinearVelocityDirection, InputVelocityOffsetAngle(), FVector(0.f, 0.f, 1.f));
+		OutLines.Emplace(ActorLocation, ActorLocation + (AccelerationDirection * 120.f), FColor::Yellow, 0.f, 2.f, SDPG_World);
+	}
+
+	if (bTrajectoryEnabled)
+	{
+		PredictedTrajectory.AppendDebugLines(OutLines, GetPawnOwner()->GetActorTransform(), SampleStride);
+	}
+}
+#endif
+
+bool URGTrajectoryMovementComponent::IsInputPresent(bool bAllowGrace) const
+{
+	if (IsSimulatedProxy() && bAllowGrace)
+	{
+		return bInputPresent || (GetTime() - InputStoppedAt < 0.01);
+	}
+
+	return bInputPresent;
+}
+
+void URGTrajectoryMovementComponent::UpdateCalculatedEffectiveAcceleration()
+{
+	if (GetLinearVelocity_GMC().IsZero() || !MotionEstimator.IsValid())
+	{
+		CalculatedEffectiveAcceleration = FVector::ZeroVector;
+		return;
+	}
+
+	CalculatedEffectiveAcceleration = HistoryAnchor.TransformVectorNoScale(MotionEstimator.GetAcceleration());
+}
+
+bool URGTrajectoryMovementComponent::ExtrapolateProxyState(double Time, FVector& OutLocation, FVector& OutVelocity,
+	FRotator& OutRotation) const
+{
+	if (ProxyExtrapolationStartTime < 0.0) return false;
+
+	ProxyExtrapolationModel.Evaluate(static_cast<float>(FMath::Max(Time - ProxyExtrapolationStartTime, 0.0)), OutLocation, OutVelocity, OutRotation);
+	return true;
+}
+
+void URGTrajectoryMovementComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// The owning client predicts its own movement, and has no use for this.
+	DOREPLIFETIME_CONDITION(URGTrajectoryMovementComponent, ProxyExtrapolationState, COND_SimulatedOnly);
+}
+
+void URGTrajectoryMovementComponent::StartProxyExtrapolation(const FRGTrajectoryModelInput& Input, double Time)
+{
+	ProxyExtrapolationModel.Initialize(Input);
+	ProxyExtrapolationStartTime = Time;
+}
+
+void URGTrajectoryMovementComponent::CheckProxyExtrapolation()
+{
+	APawn* Owner = GetPawnOwner();
+	if (!bTrajectoryEnabled || !IsValid(Owner) || GetMovementMode() == GetRagdollMode()) return;
+
+	// The same model PredictMovementFuture uses, from the state an update sent now would carry.
+	const double Time = GetTime();
+	const FTransform CurrentTransform = Owner->GetActorTransform();
+	FRGTrajectoryModelInput Input;
+	BuildTrajectoryModelInput(CurrentTransform, Input);
+	Input.Velocity = GetLinearVelocity_GMC();
+	Input.Horizon = FMath::Max(ProxyMaxUpdateInterval, TrajectorySimSeconds);
+
+	// Proxies only get our yaw, so extrapolate from exactly what they'll have.
+	Input.Rotation = FRotator(0.f, Input.Rotation.Yaw, 0.f);
+
+	bool bSendUpdate = ProxyExtrapolationStartTime < 0.0 || Time - ProxyExtrapolationStartTime >= ProxyMaxUpdateInterval ||
+		ProxyExtrapolationModel.GetType() != Input.Type;
+
+	if (!bSendUpdate)
+	{
+		FVector Location;
+		FVector Velocity;
+		FRotator Rotation;
+		ExtrapolateProxyState(Time, Location, Velocity, Rotation);
+
+		bSendUpdate = FVector::DistSquared(Location, CurrentTransform.GetLocation()) > FMath::Square(ProxyExtrapolationTolerance) ||
+			FMath::Abs(FRotator::NormalizeAxis(Rotation.Yaw - CurrentTransform.Rotator().Yaw)) > ProxyExtrapolationRotationTolerance;
+	}
+
+	if (!bSendUpdate) return;
+
+	// Extrapolate from the quantized values, just as proxies will.
+	ProxyExtrapolationState.Location = Input.Location;
+	ProxyExtrapolationState.Velocity = Input.Velocity;
+	ProxyExtrapolationState.Acceleration = Input.Acceleration;
+	ProxyExtrapolationState.Yaw = Input.Rotation.Yaw;
+	ProxyExtrapolationState.YawRate = Input.YawRate;
+	ProxyExtrapolationState.Time = Time;
+
+	Input.Location = ProxyExtrapolationState.Location;
+	Input.Velocity = ProxyExtrapolationState.Velocity;
+	Input.Acceleration = ProxyExtrapolationState.Acceleration;
+	StartProxyExtrapolation(Input, Time);
+	Owner->ForceNetUpdate();
+}
+
+void URGTrajectoryMovementComponent::OnRep_ProxyExtrapolationState()
+{
+	if (!IsValid(GetPawnOwner())) return;
+
+	const FRGProxyExtrapolationState& State = ProxyExtrapolationState;
+	FRGTrajectoryModelInput Input;
+	BuildTrajectoryModelInput(FTransform(FRotator(0.f, State.Yaw, 0.f), State.Location), Input);
+	Input.Velocity = State.Velocity;
+	Input.Acceleration = State.Acceleration;
+	Input.YawRate = State.YawRate;
+	Input.Horizon = FMath::Max(ProxyMaxUpdateInterval, TrajectorySimSeconds);
+	StartProxyExtrapolation(Input, State.Time);
+
+	ProxyExtrapolationReceivedAt = GetWorld()->GetTimeSeconds();
+}
+
+void URGTrajectoryMovementComponent::ApplyProxyExtrapolation(float DeltaTime)
+{
+	if (ProxyExtrapolationReceivedAt < 0.0 || !IsValid(UpdatedComponent) || GetMovementMode() == GetRagdollMode())
+	{
+		ProxyExtrapolationBlend = 0.f;
+		return;
+	}
+
+	// Fresh state is GMC's to interpolate; only once it's gone stale do we move over to the extrapolation.
+	const bool bStale = GetWorld()->GetTimeSeconds() - ProxyExtrapolationReceivedAt > ProxyInterpolationWindow;
+	ProxyExtrapolationBlend = FMath::FInterpConstantTo(ProxyExtrapolationBlend, bStale ? 1.f : 0.f, DeltaTime, 1.f / ProxyExtrapolationBlendTime);
+	if (ProxyExtrapolationBlend <= 0.f) return;
+
+	// Our GMC time is on the server's timeline, so this is where the server's model says we are as of the state
+	// GMC is currently showing.
+	FVector Location;
+	FVector Velocity;
+	FRotator Rotation;
+	if (!ExtrapolateProxyState(GetTime(), Location, Velocity, Rotation)) return;
+
+	// GMC sets its own state afresh every simulation tick, so blending on top of it never compounds.
+	const float Alpha = ProxyExtrapolationBlend;
+	SetActorLocation_GMC(FMath::Lerp(GetActorLocation_GMC(), Location, Alpha));
+	SetActorRotation_GMC(FQuat::Slerp(UpdatedComponent->GetComponentQuat(), Rotation.Quaternion(), Alpha).Rotator());
+	SetLinearVelocity_GMC(FMath::Lerp(GetLinearVelocity_GMC(), Velocity, Alpha));
+}
+
+void URGTrajectoryMovementComponent::UpdateStopPrediction()
+{
+	const FRGTrajectorySnapshot& Snapshot = TrajectorySnapshot;
+
+	double Seconds;
+	PredictedStopPoint = RGTrajectoryCore::ToEngine(RGTrajectoryCore::GroundedStopOffset(RGTrajectoryCore::ToCore(Snapshot.LinearVelocity),
+		Snapshot.BrakingDeceleration, Snapshot.GroundFriction, &Seconds));
+	PredictedStopSeconds = Seconds;
+	bTrajectoryIsStopping = !PredictedStopPoint.IsZero() && !Snapshot.bInputPresent;
 }
 
 void URGTrajectoryMovementComponent::UpdatePivotPrediction()
 {
-	const FRotator Rotation = GetActorRotation_GMC();
-	
-	PredictedPivotPoint = PredictGroundedPivotLocation(GetCurrentEffectiveAcceleration(), GetLinearVelocity_GMC(), Rotation, GroundFriction);
-	bTrajectoryIsPivoting = !PredictedPivotPoint.IsZero() && IsInputPresent() && DoInputAndVelocityDiffer();
+	const FRGTrajectorySnapshot& Snapshot = TrajectorySnapshot;
+
+	double Seconds;
+	PredictedPivotPoint = RGTrajectoryCore::ToEngine(RGTrajectoryCore::GroundedPivotOffset(RGTrajectoryCore::ToCore(Snapshot.EffectiveAcceleration),
+		RGTrajectoryCore::ToCore(Snapshot.LinearVelocity), Snapshot.GroundFriction, &Seconds));
+	PredictedPivotSeconds = Seconds;
+	bTrajectoryIsPivoting = !PredictedPivotPoint.IsZero() && Snapshot.bInputPresent && Snapshot.bInputAndVelocityDiffer;
 }
 
 bool URGTrajectoryMovementComponent::IsStopPredicted(FVector& OutStopPrediction) const
@@ -387,331 +1006,1414 @@ bool URGTrajectoryMovementComponent::IsPivotPredicted(FVector& OutPivotPredictio
 	return bTrajectoryIsPivoting;
 }
 
-FVector URGTrajectoryMovementComponent::PredictGroundedStopLocation(const FVector& CurrentVelocity,
-	float BrakingDeceleration, float Friction)
+void URGTrajectoryMovementComponent::UpdateLandingPrediction()
 {
-	FVector Result = FVector::ZeroVector;
-	
-	const FVector GroundedVelocity = CurrentVelocity * FVector(1.f, 1.f, 0.f);
-	const FVector GroundedDirection = GroundedVelocity.GetSafeNormal();
-
-	if (const float RealBrakingDeceleration = BrakingDeceleration * Friction; RealBrakingDeceleration > 0.f)
+	if (TrajectorySnapshot.MovementMode != EGMC_MovementMode::Airborne)
 	{
-		Result = GroundedDirection * (GroundedVelocity.SizeSquared() / (2 * RealBrakingDeceleration));
+		bTrajectoryIsLanding = false;
+		PredictedLandingPoint = FVector::ZeroVector;
+		PredictedLandingSeconds = 0.f;
+		return;
 	}
 
-	return Result;
+	const FTransform& Origin = TrajectorySnapshot.ActorTransform;
+	FRGTrajectoryModel Model;
+	BuildTrajectoryModel(Origin, Model);
+
+	bTrajectoryIsLanding = Model.GetLandingTime() >= 0.f;
+	PredictedLandingSeconds = bTrajectoryIsLanding ? Model.GetLandingTime() : 0.f;
+	PredictedLandingPoint = bTrajectoryIsLanding ? Model.GetLandingLocation() - Origin.GetLocation() : FVector::ZeroVector;
 }
 
-FVector URGTrajectoryMovementComponent::PredictGroundedPivotLocation(const FVector& CurrentAcceleration,
-	const FVector& CurrentVelocity, const FRotator& CurrentRotation, float Friction)
+bool URGTrajectoryMovementComponent::IsLandingPredicted(FVector& OutLandingPrediction, float& OutSecondsToLanding) const
 {
-	FVector Result = FVector::ZeroVector;
-	const FVector EffectiveAcceleration = CurrentAcceleration;
-	
-	const FVector GroundedVelocity = CurrentVelocity * FVector(1.f, 1.f, 0.f);
-	const FVector LocalVelocity = UKismetMathLibrary::LessLess_VectorRotator(GroundedVelocity, CurrentRotation);
-	const FVector LocalAcceleration = UKismetMathLibrary::LessLess_VectorRotator(EffectiveAcceleration, CurrentRotation);
-
-	const FVector Acceleration2D = EffectiveAcceleration * FVector(1.f, 1.f, 0.f);
-	FVector AccelerationDir2D;
-	float AccelerationSize2D;
-	Acceleration2D.ToDirectionAndLength(AccelerationDir2D, AccelerationSize2D);
-
-	const float VelocityAlongAcceleration = (GroundedVelocity | AccelerationDir2D);
-	const float DotProduct = UKismetMathLibrary::Dot_VectorVector(LocalVelocity, LocalAcceleration);
-
-	if (DotProduct < 0.f && VelocityAlongAcceleration < 0.f)
-	{
-		const float SpeedAlongAcceleration = -VelocityAlongAcceleration;
-		const float Divisor = AccelerationSize2D + 2.f * SpeedAlongAcceleration * Friction;
-		const float TimeToDirectionChange = SpeedAlongAcceleration / Divisor;
-
-		const FVector AccelerationForce = EffectiveAcceleration -
-			(GroundedVelocity - AccelerationDir2D * GroundedVelocity.Size2D()) * Friction;
+	OutLandingPrediction = PredictedLandingPoint;
+	OutSecondsToLanding = PredictedLandingSeconds;
+	return bTrajectoryIsLanding;
+}
 
-		Result = GroundedVelocity * TimeToDirectionChange + 0.5f * AccelerationForce *
-			TimeToDirectionChange * TimeToDirectionChange;
-	}
+FVector URGTrajectoryMovementComponent::PredictGroundedStopLocation(const FVector& CurrentVelocity,
+	float BrakingDeceleration, float Friction)
+{
+	return RGTrajectoryCore::ToEngine(RGTrajectoryCore::GroundedStopOffset(RGTrajectoryCore::ToCore(CurrentVelocity), BrakingDeceleration, Friction));
+}
 
-	return Result;
+FVector URGTrajectoryMovementComponent::PredictGroundedPivotLocation(const FVector& CurrentAcceleration,
+	const FVector& CurrentVelocity, float Friction)
+{
+	return RGTrajectoryCore::ToEngine(RGTrajectoryCore::GroundedPivotOffset(RGTrajectoryCore::ToCore(CurrentAcceleration),
+		RGTrajectoryCore::ToCore(CurrentVelocity), Friction));
 }
 
 FRGMovementSampleCollection URGTrajectoryMovementComponent::GetMovementHistory(bool bOmitLatest) const
 {
 	FRGMovementSampleCollection Result;
+	AppendMovementHistory(Result.Samples, bOmitLatest);
+	return Result;
+}
+
+void URGTrajectoryMovementComponent::AppendMovementHistory(TArray<FRGMovementSample>& OutSamples, bool bOmitLatest) const
+{
+	// Skip anything from before a break; it'll be culled once the next sample comes in.
+	int32 FirstIdx = 0;
+	while (FirstIdx < MovementHistory.Num() && MovementHistory[FirstIdx].Sequence < HistoryBreakSequence)
+	{
+		FirstIdx++;
+	}
 
-	const int32 TrajectoryHistoryCount = MovementSamples.Num();
-	if (TrajectoryHistoryCount > 0)
+	const int32 EndIdx = MovementHistory.Num() - (bOmitLatest ? 1 : 0);
+	if (EndIdx > FirstIdx)
 	{
-		Result.Samples.Reserve(TrajectoryHistoryCount);
+		OutSamples.Reserve(OutSamples.Num() + EndIdx - FirstIdx);
 
-		int32 Counter = 0;
-		for (auto& Sample : MovementSamples)
+		const FRGTrajectoryHistoryEntry& Latest = MovementHistory.Last();
+		for (int32 Idx = FirstIdx; Idx < EndIdx; Idx++)
 		{
-			Counter++;
-			if (!bOmitLatest || Counter != TrajectoryHistoryCount - 1)
-				Result.Samples.Emplace(Sample);
+			OutSamples.Emplace(ResolveHistorySample(MovementHistory[Idx], Latest));
 		}
 	}
+}
 
+FRGMovementSample URGTrajectoryMovementComponent::ResolveHistorySample(const FRGTrajectoryHistoryEntry& Entry, const FRGTrajectoryHistoryEntry& Latest) const
+{
+	// Relative data doesn't depend on the anchor, since both entries share it.
+	FRGMovementSample Result = Entry.Sample;
+	Result.AccumulatedSeconds = Entry.Time - Latest.Time;
+	Result.RelativeTransform = Entry.Sample.WorldTransform.GetRelativeTransform(Latest.Sample.WorldTransform);
+	Result.RelativeLinearVelocity = Latest.Sample.WorldTransform.InverseTransformVectorNoScale(Entry.Sample.WorldLinearVelocity);
+
+	Result.WorldTransform = Entry.Sample.WorldTransform * HistoryAnchor;
+	Result.WorldLinearVelocity = HistoryAnchor.TransformVectorNoScale(Entry.Sample.WorldLinearVelocity);
+	Result.ActorWorldRotation = HistoryAnchor.TransformRotation(Entry.Sample.ActorWorldRotation.Quaternion()).Rotator();
 	return Result;
 }
 
-FRGMovementSampleCollection URGTrajectoryMovementComponent::PredictMovementFuture(const FTransform& FromOrigin, bool bIncludeHistory) const
+FRGMovementSample URGTrajectoryMovementComponent::ResolveHistoryKeyframe(const FRGTrajectoryKeyframe& Keyframe, const FRGTrajectoryHistoryEntry& Latest) const
 {
-	const float TimePerSample = 1.f / TrajectorySimSampleRate;
-	const int32 TotalSimulatedSamples = FMath::TruncToInt32(TrajectorySimSampleRate * TrajectorySimSeconds);
-
-	const int32 TotalCollectionSize = TotalSimulatedSamples + 1 + bIncludeHistory ? MovementSamples.Num() : 0;
-	
-	FRGMovementSample SimulatedSample = LastMovementSample;
-	FRGMovementSampleCollection Predictions;
-	Predictions.Samples.Reserve(TotalCollectionSize);
+	FRGTrajectoryHistoryEntry Entry;
+	Entry.Time = Keyframe.Time;
+	Entry.Sample = FRGMovementSample(FTransform(Keyframe.Rotation, Keyframe.Location), Keyframe.Velocity);
+	Entry.Sample.ActorWorldRotation = Keyframe.Rotation.Rotator();
+	return ResolveHistorySample(Entry, Latest);
+}
 
-	if (bIncludeHistory)
-	{
-		Predictions.Samples.Append(GetMovementHistory(false).Samples);
-	}
-	Predictions.Samples.Add(GetMovementSampleFromCurrentState());
+void URGTrajectoryMovementComponent::ArchiveHistoryEntry(const FRGTrajectoryHistoryEntry& Entry)
+{
+	if (LongHistorySeconds <= 0.f || Entry.Sequence < HistoryBreakSequence) return;
 
-	FRotator RotationVelocity;
-	FVector PredictedAcceleration;
-	GetCurrentAccelerationRotationVelocityFromHistory(PredictedAcceleration, RotationVelocity);
-	FRotator RotationVelocityPerSample = RotationVelocity * TimePerSample;
+	LongHistory.Add(FRGTrajectoryKeyframe(Entry));
+	LongHistory.CullBefore(Entry.Time - LongHistorySeconds);
+}
 
-	const float BrakingDeceleration = GetBrakingDeceleration();
-	const float BrakingFriction = GroundFriction;
-	const float MaxSpeed = GetMaxSpeed();
+bool URGTrajectoryMovementComponent::SampleMovementHistory(float SecondsAgo, FRGMovementSample& OutSample) const
+{
+	if (MovementHistory.IsEmpty() || MovementHistory.Last().Sequence < HistoryBreakSequence) return false;
 
-	const bool bZeroFriction = BrakingFriction == 0.f;
-	const bool bNoBrakes = BrakingDeceleration == 0.f;
-	
-	FVector CurrentLocation = FromOrigin.GetLocation();
-	FRotator CurrentRotation = FromOrigin.GetRotation().Rotator();
-	FVector CurrentVelocity = GetLinearVelocity_GMC();
+	const FRGTrajectoryHistoryEntry& Latest = MovementHistory.Last();
+	const double Time = Latest.Time - FMath::Max(SecondsAgo, 0.f);
 
-	for (int32 Idx = 0; Idx < TotalSimulatedSamples; Idx++)
+	// Find the first live entry; anything before a break is waiting to be culled.
+	int32 Low = 0;
+	int32 High = MovementHistory.Num() - 1;
+	while (Low < High)
 	{
-		if (!RotationVelocityPerSample.IsNearlyZero())
+		const int32 Mid = (Low + High) / 2;
+		if (MovementHistory[Mid].Sequence < HistoryBreakSequence)
+		{
+			Low = Mid + 1;
+		}
+		else
 		{
-			PredictedAcceleration = RotationVelocityPerSample.RotateVector(PredictedAcceleration);
-			CurrentRotation += RotationVelocityPerSample;
-			RotationVelocityPerSample.Yaw /= 1.1f;
+			High = Mid;
 		}
+	}
+	const int32 FirstIdx = Low;
 
-		if (PredictedAcceleration.IsNearlyZero())
+	FRGTrajectoryKeyframe Keyframe;
+	if (Time < MovementHistory[FirstIdx].Time)
+	{
+		// Older than the full-rate history, so it's either in the long history or between the two.
+		const FRGTrajectoryKeyframe Oldest(MovementHistory[FirstIdx]);
+		if (LongHistory.IsEmpty())
+		{
+			Keyframe = Oldest;
+		}
+		else if (Time < LongHistory.Last().Time)
 		{
-			if (!CurrentVelocity.IsNearlyZero())
+			LongHistory.Sample(Time, Keyframe);
+		}
+		else
+		{
+			Keyframe = FRGTrajectoryKeyframe::Interpolate(LongHistory.Last(), Oldest, Time);
+		}
+	}
+	else
+	{
+		// Find the last entry at or before the requested time.
+		Low = FirstIdx;
+		High = MovementHistory.Num() - 1;
+		while (Low < High)
+		{
+			const int32 Mid = (Low + High + 1) / 2;
+			if (MovementHistory[Mid].Time <= Time)
 			{
-				const FVector Deceleration = bNoBrakes ? FVector::ZeroVector : -BrakingDeceleration * CurrentVelocity.GetSafeNormal();
-
-				constexpr float MaxPredictedTrajectoryTimeStep = 1.f / 33.f;
-				const FVector PreviousVelocity = CurrentVelocity;
-
-				float RemainingTime = TimePerSample;
-				while (RemainingTime >= 1e-6f && !CurrentVelocity.IsZero())
-				{
-					const float dt = RemainingTime > MaxTimeStep && !bZeroFriction ?
-						FMath::Min(MaxPredictedTrajectoryTimeStep, RemainingTime * 0.5f) : RemainingTime;
-					RemainingTime -= dt;
-
-					CurrentVelocity = CurrentVelocity + (-BrakingFriction * CurrentVelocity + Deceleration) * dt;
-					if ((CurrentVelocity | PreviousVelocity) < 0.f)
-					{
-						CurrentVelocity = FVector::ZeroVector;
-						break;
-					}
-				}
-
-				if (CurrentVelocity.SizeSquared() < KINDA_SMALL_NUMBER)
-				{
-					CurrentVelocity = FVector::ZeroVector;
-				}
+				Low = Mid;
 			}
 			else
 			{
-				CurrentVelocity = FVector::ZeroVector;
+				High = Mid - 1;
 			}
 		}
-		else
-		{
-			const FVector AccelerationDirection = PredictedAcceleration.GetSafeNormal();
-			const float Speed = CurrentVelocity.Size();
-
-			CurrentVelocity = CurrentVelocity - (CurrentVelocity - AccelerationDirection * Speed) *
-				(BrakingFriction * TimePerSample);
 
-			CurrentVelocity += PredictedAcceleration * TimePerSample;
-			CurrentVelocity = CurrentVelocity.GetClampedToMaxSize(MaxSpeed);
+		if (Low == MovementHistory.Num() - 1 || MovementHistory[Low].Time == Time)
+		{
+			OutSample = ResolveHistorySample(MovementHistory[Low], Latest);
+			return true;
 		}
+		Keyframe = FRGTrajectoryKeyframe::Interpolate(FRGTrajectoryKeyframe(MovementHistory[Low]), FRGTrajectoryKeyframe(MovementHistory[Low + 1]), Time);
+	}
 
-		CurrentLocation += CurrentVelocity * TimePerSample;
-		
-		const FTransform NewTransform = FTransform(CurrentRotation.Quaternion(), CurrentLocation);
-		const FTransform NewRelativeTransform = NewTransform.GetRelativeTransform(FromOrigin);
+	OutSample = ResolveHistoryKeyframe(Keyframe, Latest);
+	return true;
+}
 
-		SimulatedSample = FRGMovementSample();
-		SimulatedSample.RelativeTransform = NewRelativeTransform;
-		SimulatedSample.RelativeLinearVelocity = FromOrigin.InverseTransformVectorNoScale(CurrentVelocity);
-		SimulatedSample.WorldTransform = NewTransform;
-		SimulatedSample.WorldLinearVelocity = CurrentVelocity;
-		SimulatedSample.AccumulatedSeconds = TimePerSample * (Idx + 1);
+FRGMovementSampleCollection URGTrajectoryMovementComponent::GetLongMovementHistory() const
+{
+	FRGMovementSampleCollection Result;
+	if (MovementHistory.IsEmpty()) return Result;
 
-		Predictions.Samples.Emplace(SimulatedSample);
+	Result.Samples.Reserve(LongHistory.Num() + MovementHistory.Num());
+	for (int32 Idx = 0; Idx < LongHistory.Num(); Idx++)
+	{
+		Result.Samples.Emplace(ResolveHistoryKeyframe(LongHistory[Idx], MovementHistory.Last()));
 	}
-
-	return Predictions;
+	AppendMovementHistory(Result.Samples, false);
+	return Result;
 }
 
-void URGTrajectoryMovementComponent::UpdateTrajectoryPrediction()
+FRGMovementSample URGTrajectoryMovementComponent::ToHistorySpace(const FRGMovementSample& Sample) const
 {
-	PredictedTrajectory = PredictMovementFuture(GetPawnOwner()->GetActorTransform(), true);
+	FRGMovementSample Result = Sample;
+	Result.WorldTransform = Sample.WorldTransform.GetRelativeTransform(HistoryAnchor);
+	Result.WorldLinearVelocity = HistoryAnchor.InverseTransformVectorNoScale(Sample.WorldLinearVelocity);
+	Result.ActorWorldRotation = HistoryAnchor.InverseTransformRotation(Sample.ActorWorldRotation.Quaternion()).Rotator();
+	return Result;
 }
 
-FRGMovementSample URGTrajectoryMovementComponent::GetMovementSampleFromCurrentState() const
+void URGTrajectoryMovementComponent::ReanchorHistory(const FTransform& FromTransform, const FTransform& ToTransform,
+	bool bCarryHistory)
 {
-	FTransform CurrentTransform = GetPawnOwner()->GetActorTransform();
-	const FVector CurrentLocation = GetLowerBound();
-	CurrentTransform.SetLocation(CurrentLocation);
-
-	FRGMovementSample Result = FRGMovementSample(CurrentTransform, GetLinearVelocity_GMC());
-	Result.ActorWorldRotation = GetPawnOwner()->GetActorRotation();
-	if (!LastMovementSample.IsZeroSample())
+	if (bCarryHistory)
 	{
-		Result.ActorDeltaRotation = Result.ActorWorldRotation - LastMovementSample.ActorWorldRotation;
+		// Move the history (and the motion estimate, which shares the anchor) rigidly along with the pawn.
+		HistoryAnchor = HistoryAnchor * (FromTransform.Inverse() * ToTransform);
+		HistoryAnchor.SetScale3D(FVector::OneVector);
+		MotionEstimator.MarkDiscontinuity();
+		if (!MovementHistory.IsEmpty())
+		{
+			LastMovementSample = ResolveHistorySample(MovementHistory.Last(), MovementHistory.Last());
+		}
+	}
+	else
+	{
+		// Leave the old entries to be culled as new samples come in, but stop reporting them.
+		HistoryBreakSequence = NextHistorySequence;
+		LongHistory.Reset();
+		LastMovementSample.Reset();
+		MotionEstimator.Reset();
+		EffectiveTrajectoryTimeDomain = 0.f;
 	}
 
-	return Result;
+	// Anything found along the old path no longer applies.
+	PredictionBlock = FPredictionBlock();
+
+	bHistoryDiscontinuityPending = true;
+	OnTrajectoryDiscontinuity.Broadcast(bCarryHistory);
 }
 
-void URGTrajectoryMovementComponent::AddNewMovementSample(const FRGMovementSample& NewSample)
+URGTrajectoryMovementComponent::FHistoryCheckpoint URGTrajectoryMovementComponent::CheckpointHistory() const
 {
-	const float GameSeconds = UKismetSystemLibrary::GetGameTimeInSeconds(GetWorld());
-	if (LastTrajectoryGameSeconds != 0.f)
+	FHistoryCheckpoint Checkpoint;
+	if (!MovementHistory.IsEmpty())
 	{
-		const float DeltaSeconds = GameSeconds - LastTrajectoryGameSeconds;
-		const float DeltaDistance = NewSample.DistanceFrom(LastMovementSample);
-		const FTransform DeltaTransform = LastMovementSample.WorldTransform.GetRelativeTransform(NewSample.WorldTransform);
+		Checkpoint.Sequence = MovementHistory.Last().Sequence;
+		Checkpoint.Time = MovementHistory.Last().Time;
+	}
+	return Checkpoint;
+}
 
-		for (auto& Sample : MovementSamples)
-		{
-			Sample.PrependRelativeOffset(DeltaTransform, -DeltaSeconds);
-		}
+void URGTrajectoryMovementComponent::RestoreHistory(const FHistoryCheckpoint& Checkpoint)
+{
+	if (MovementHistory.IsEmpty() || MovementHistory.Last().Sequence <= Checkpoint.Sequence) return;
 
-		CullMovementSampleHistory(FMath::IsNearlyZero(DeltaDistance), NewSample);
+	while (!MovementHistory.IsEmpty() && MovementHistory.Last().Sequence > Checkpoint.Sequence)
+	{
+		MovementHistory.PopBack();
 	}
-
-	MovementSamples.Emplace(NewSample);
-	LastMovementSample = NewSample;
-	LastTrajectoryGameSeconds = GameSeconds;	
+	SyncToHistoryTail();
 }
 
-void URGTrajectoryMovementComponent::CullMovementSampleHistory(bool bIsNearlyZero, const FRGMovementSample& LatestSample)
+void URGTrajectoryMovementComponent::RewindHistoryTo(double Time)
 {
-	const FRGMovementSample FirstSample = MovementSamples.First();
-	const float FirstSampleTime = FirstSample.AccumulatedSeconds;
+	if (MovementHistory.IsEmpty() || MovementHistory.Last().Time <= Time) return;
 
-	if (bIsNearlyZero && !FirstSample.IsZeroSample())
+	while (!MovementHistory.IsEmpty() && MovementHistory.Last().Time > Time)
 	{
-		// We were moving, and stopped.
-		if (EffectiveTrajectoryTimeDomain == 0.f)
-		{
-			// Initialize a time horizon while we're motionless, to allow uniform decay to continue.
-			EffectiveTrajectoryTimeDomain = FirstSampleTime;
-		}
+		MovementHistory.PopBack();
 	}
-	else
+	LongHistory.DiscardAfter(Time);
+	SyncToHistoryTail();
+}
+
+void URGTrajectoryMovementComponent::SyncToHistoryTail()
+{
+	if (MovementHistory.IsEmpty())
 	{
-		// We're moving again, so we no longer need a horizon.
+		LastMovementSample.Reset();
+		MotionEstimator.Reset();
 		EffectiveTrajectoryTimeDomain = 0.f;
+		return;
 	}
 
-	MovementSamples.RemoveAll([&](const FRGMovementSample& TestSample)
+	LastMovementSample = ResolveHistorySample(MovementHistory.Last(), MovementHistory.Last());
+	MotionEstimator = MovementHistory.Last().Estimator;
+}
+
+void URGTrajectoryMovementComponent::ImportMassTrajectory(const FRGTrajectoryMassHistoryFragment& History,
+	const FRGTrajectoryMassStateFragment& State, double MassTime)
+{
+	// Mass stamps history with world time; ours runs on GMC's synchronized time.
+	const double TimeOffset = GetTime() - MassTime;
+
+	MovementHistory.Reset();
+	LongHistory.Reset();
+	AdaptiveHistoryWindow.Reset();
+	HistoryAnchor = FTransform::Identity;
+	HistoryBreakSequence = NextHistorySequence;
+	EffectiveTrajectoryTimeDomain = 0.f;
+	PredictionBlock = FPredictionBlock();
+
+	// Older entries get an estimate rebuilt from the agent's history, so that rewinding into them still works;
+	// the latest takes the agent's own, which saw every frame rather than just the recorded ones.
+	MotionEstimator.Reset();
+	MotionEstimator.SmoothingTime = TrajectoryEstimatorSmoothingTime;
+	MotionEstimator.AccelerationSmoothingTime = TrajectoryEstimatorSmoothingTime * 2.f;
+	for (int32 Idx = 0; Idx < History.Num(); Idx++)
 	{
-		if (TestSample.IsZeroSample() && LatestSample.IsZeroSample())
-		{
-			// We don't need duplicate zero motion samples, they just clutter the history.
-			return true;
-		}
+		const FRGTrajectoryMassSample& MassSample = History[Idx];
+		const FRotator Rotation(0.f, MassSample.Yaw, 0.f);
 
-		if (TestSample.AccumulatedSeconds < -TrajectoryHistorySeconds)
-		{
-			// Sample is too old for the buffer.
-			return true;
-		}
+		FRGTrajectoryHistoryEntry Entry;
+		Entry.Sequence = NextHistorySequence++;
+		Entry.Time = MassSample.Time + TimeOffset;
+		Entry.Sample = FRGMovementSample(FTransform(Rotation, MassSample.Location), MassSample.Velocity);
+		Entry.Sample.ActorWorldRotation = Rotation;
 
-		if (EffectiveTrajectoryTimeDomain != 0.f && (TestSample.AccumulatedSeconds < EffectiveTrajectoryTimeDomain))
+		MotionEstimator.Update(Entry.Time, MassSample.Location, MassSample.Velocity, Rotation, true);
+		Entry.Estimator = MotionEstimator;
+
+		if (!MovementHistory.IsEmpty() && MovementHistory.IsFull())
 		{
-			// Time horizon is in effect, prune everything before our zero motion moment.
-			return true;
+			ArchiveHistoryEntry(MovementHistory.First());
 		}
+		MovementHistory.Emplace(MoveTemp(Entry));
+	}
 
-		// Keep the sample
-		return false;
-	});	
+	if (!MovementHistory.IsEmpty())
+	{
+		FRGMotionEstimator& Estimator = MovementHistory.Last().Estimator;
+		Estimator = State.Estimator;
+		Estimator.ShiftTime(TimeOffset);
+		Estimator.SmoothingTime = TrajectoryEstimatorSmoothingTime;
+		Estimator.AccelerationSmoothingTime = TrajectoryEstimatorSmoothingTime * 2.f;
+	}
+	SyncToHistoryTail();
+
+	bTrajectoryIsStopping = State.bIsStopping;
+	PredictedStopPoint = State.StopPoint;
+	PredictedStopSeconds = State.StopSeconds;
+	bTrajectoryIsPivoting = State.bIsPivoting;
+	PredictedPivotPoint = State.PivotPoint;
+	PredictedPivotSeconds = State.PivotSeconds;
+
+	// Pick up event detection where the agent left off, so that the handover itself doesn't read as a start,
+	// stop or change of input.
+	bEventWasStopping = State.bIsStopping;
+	bEventWasPivoting = State.bIsPivoting;
+	bEventWasMoving = !LastMovementSample.WorldLinearVelocity.IsNearlyZero();
+	bEventHadInput = State.bInputPresent;
+	PendingTrajectoryEvents.Reset();
 }
 
-void URGTrajectoryMovementComponent::GetCurrentAccelerationRotationVelocityFromHistory(FVector& OutAcceleration,
-	FRotator& OutRotationVelocity) const
+void URGTrajectoryMovementComponent::ExportMassTrajectory(FRGTrajectoryMassHistoryFragment& OutHistory,
+	FRGTrajectoryMassStateFragment& OutState, double MassTime) const
 {
-	const auto HistoryArray = MovementSamples;
-	if (HistoryArray.IsEmpty())
+	const double TimeOffset = MassTime - GetTime();
+
+	OutHistory.Reset();
+	OutState = FRGTrajectoryMassStateFragment();
+	if (MovementHistory.IsEmpty() || MovementHistory.Last().Sequence < HistoryBreakSequence) return;
+
+	// The agent keeps fewer samples than we do, so it gets the newest.
+	int32 FirstIdx = FMath::Max(0, MovementHistory.Num() - FRGTrajectoryMassHistoryFragment::MaxSamples);
+	while (MovementHistory[FirstIdx].Sequence < HistoryBreakSequence)
 	{
-		OutAcceleration = FVector::ZeroVector;
-		OutRotationVelocity = FRotator::ZeroRotator;
-		return;
+		FirstIdx++;
 	}
-	
-	for (int32 Idx = HistoryArray.Num() - 1; Idx >= 0; Idx--)
+
+	const FRGTrajectoryHistoryEntry& Latest = MovementHistory.Last();
+	for (int32 Idx = FirstIdx; Idx < MovementHistory.Num(); Idx++)
 	{
-		const FRGMovementSample Sample = HistoryArray[Idx];
+		const FRGMovementSample Sample = ResolveHistorySample(MovementHistory[Idx], Latest);
+
+		FRGTrajectoryMassSample MassSample;
+		MassSample.Time = MovementHistory[Idx].Time + TimeOffset;
+		MassSample.Location = Sample.WorldTransform.GetLocation();
+		MassSample.Velocity = Sample.WorldLinearVelocity;
+		MassSample.Yaw = Sample.ActorWorldRotation.Yaw;
+		OutHistory.Add(MassSample);
+	}
 
-		if (LastMovementSample.AccumulatedSeconds - Sample.AccumulatedSeconds >= 0.01f)
-		{
-			OutRotationVelocity = LastMovementSample.GetRotationVelocityFrom(Sample);
-			OutAcceleration = LastMovementSample.GetAccelerationFrom(Sample);
-			return;
-		}
-	}	
+	// Our estimate lives in history space, which the agent doesn't have.
+	OutState.Estimator = MotionEstimator;
+	OutState.Estimator.TransformBy(HistoryAnchor);
+	OutState.Estimator.ShiftTime(TimeOffset);
+
+	OutState.bIsStopping = bTrajectoryIsStopping;
+	OutState.StopPoint = PredictedStopPoint;
+	OutState.StopSeconds = PredictedStopSeconds;
+	OutState.bIsPivoting = bTrajectoryIsPivoting;
+	OutState.PivotPoint = PredictedPivotPoint;
+	OutState.PivotSeconds = PredictedPivotSeconds;
+	OutState.bInputPresent = IsInputPresent(false);
 }
 
-void URGTrajectoryMovementComponent::UpdateMovementSamples_Implementation()
+FRGMovementSampleCollection URGTrajectoryMovementComponent::PredictMovementFuture(const FTransform& FromOrigin, bool bIncludeHistory) const
 {
-	const float GameSeconds = UKismetSystemLibrary::GetGameTimeInSeconds(GetWorld());
-	if (GameSeconds - LastTrajectoryGameSeconds > SMALL_NUMBER)
-	{
-		AddNewMovementSample(GetMovementSampleFromCurrentState());
-	}	
+	FRGMovementSampleCollection Predictions;
+	PredictMovementFutureInto(Predictions.Samples, FromOrigin, bIncludeHistory);
+	return Predictions;
 }
 
-void URGTrajectoryMovementComponent::EnableRagdoll()
+void URGTrajectoryMovementComponent::PredictMovementFutureInto(TArray<FRGMovementSample>& OutSamples,
+	const FTransform& FromOrigin, bool bIncludeHistory) const
 {
-	bWantsRagdoll = true;
+	const float TimePerSample = 1.f / TrajectorySimSampleRate;
+	const int32 TotalSimulatedSamples = FMath::TruncToInt32(TrajectorySimSampleRate * TrajectorySimSeconds);
+
+	const int32 TotalCollectionSize = TotalSimulatedSamples + 1 + (bIncludeHistory ? MovementHistory.Num() : 0);
+	
+	OutSamples.Reset(TotalCollectionSize);
+
+	if (bIncludeHistory)
+	{
+		AppendMovementHistory(OutSamples, false);
+	}
+	OutSamples.Add(GetMovementSampleFromCurrentState());
+
+	FRGTrajectoryModel Model;
+	BuildTrajectoryModel(FromOrigin, Model);
+
+	// Each sample is evaluated independently, so the cost is per output sample rather than per simulation step.
+	const int32 FirstPredictedIdx = OutSamples.Num();
+	OutSamples.SetNum(FirstPredictedIdx + TotalSimulatedSamples);
+	Model.MakeSamples(TotalSimulatedSamples, TimePerSample, FromOrigin, OutSamples.GetData() + FirstPredictedIdx);
+	FollowPredictionPath(FromOrigin, MakeArrayView(OutSamples.GetData() + FirstPredictedIdx, TotalSimulatedSamples));
+	SpliceRootMotion(Model, FromOrigin, MakeArrayView(OutSamples.GetData() + FirstPredictedIdx, TotalSimulatedSamples));
 }
 
-void URGTrajectoryMovementComponent::DisableRagdoll()
+FRGMovementSample URGTrajectoryMovementComponent::PredictMovementAtTime(const FTransform& FromOrigin,
+	float SecondsInFuture) const
 {
-	bWantsRagdoll = false;
+	FRGTrajectoryModel Model;
+	BuildTrajectoryModel(FromOrigin, Model);
+
+	FRGMovementSample Sample = Model.MakeSample(FMath::Max(SecondsInFuture, 0.f), FromOrigin);
+	FollowPredictionPath(FromOrigin, MakeArrayView(&Sample, 1));
+	SpliceRootMotion(Model, FromOrigin, MakeArrayView(&Sample, 1));
+	return Sample;
 }
 
-void URGTrajectoryMovementComponent::SetRagdollActive(bool bActive)
+TArray<FRGMovementSampleCollection> URGTrajectoryMovementComponent::PredictMovementHypotheses(
+	const TArray<ERGTrajectoryHypothesis>& Hypotheses, const FTransform& FromOrigin) const
 {
-	if (IsNetworkedServer()) return;
-	
-	if (bActive)
+	FRGTrajectoryHypothesisSet Set;
+	PredictMovementHypothesesInto(Hypotheses, FromOrigin, Set);
+
+	TArray<FRGMovementSampleCollection> Result;
+	Result.SetNum(Set.NumHypotheses());
+	for (int32 Idx = 0; Idx < Set.NumHypotheses(); Idx++)
 	{
-		if (PreviousRelativeMeshLocation.IsZero())
-		{
-			PreviousRelativeMeshLocation = SkeletalMesh->GetRelativeLocation();
-			PreviousRelativeMeshRotation = SkeletalMesh->GetRelativeRotation();
-		}
-		HaltMovement();
+		Set.GetTrajectory(Idx, Result[Idx].Samples);
 	}
-
-	bEnablePhysicsInteraction = !bActive;
-	bFirstRagdollTick = bActive;
-	bResetMesh = !bActive;
+	return Result;
 }
 
-
+void URGTrajectoryMovementComponent::PredictMovementHypothesesInto(TConstArrayView<ERGTrajectoryHypothesis> Hypotheses,
+	const FTransform& FromOrigin, FRGTrajectoryHypothesisSet& OutSet) const
+{
+	const float TimePerSample = 1.f / TrajectorySimSampleRate;
+	const int32 TotalSimulatedSamples = FMath::TruncToInt32(TrajectorySimSampleRate * TrajectorySimSeconds);
+	const int32 NumShared = FMath::Clamp(FMath::FloorToInt32(HypothesisReactionSeconds / TimePerSample), 0, TotalSimulatedSamples);
+	const float DivergeSeconds = NumShared * TimePerSample;
+
+	OutSet.Reset(Hypotheses, NumShared, TotalSimulatedSamples - NumShared, TimePerSample, FromOrigin);
+	if (Hypotheses.IsEmpty()) return;
+
+	// The history estimate, and everything up to the point the hypotheses diverge, are the same for all of them.
+	FRGTrajectoryModelInput BaseInput;
+	BuildTrajectoryModelInput(FromOrigin, BaseInput);
+
+	FRGTrajectoryModel BaseModel;
+	BaseModel.Initialize(BaseInput);
+
+	FVector Location;
+	FVector Velocity;
+	FRotator Rotation;
+	for (int32 SampleIdx = 0; SampleIdx < NumShared; SampleIdx++)
+	{
+		BaseModel.Evaluate(OutSet.GetSampleSeconds(SampleIdx), Location, Velocity, Rotation);
+		OutSet.SetSample(0, SampleIdx, Location, Velocity, Rotation.Yaw);
+	}
+
+	if (NumShared == TotalSimulatedSamples) return;
+
+	FVector DivergeLocation;
+	FVector DivergeVelocity;
+	FRotator DivergeRotation;
+	BaseModel.Evaluate(DivergeSeconds, DivergeLocation, DivergeVelocity, DivergeRotation);
+
+	// Turns are relative to the way we'd be heading by the time we diverge.
+	FVector Heading = BaseInput.Acceleration.GetSafeNormal2D().RotateAngleAxis(DivergeRotation.Yaw - BaseInput.Rotation.Yaw, FVector::UpVector);
+	if (Heading.IsNearlyZero())
+	{
+		Heading = DivergeVelocity.IsNearlyZero() ? DivergeRotation.Vector().GetSafeNormal2D() : DivergeVelocity.GetSafeNormal2D();
+	}
+	const float TurnAccelerationSize = BaseInput.Acceleration.IsNearlyZero() ? TrajectoryMaxAcceleration : BaseInput.Acceleration.Size2D();
+
+	TArray<FRGTrajectoryModel, TInlineAllocator<4>> Models;
+	TArray<float, TInlineAllocator<4>> ModelStartSeconds;
+	Models.SetNum(Hypotheses.Num());
+	ModelStartSeconds.SetNum(Hypotheses.Num());
+
+	for (int32 Idx = 0; Idx < Hypotheses.Num(); Idx++)
+	{
+		if (Hypotheses[Idx] == ERGTrajectoryHypothesis::Continue)
+		{
+			Models[Idx] = BaseModel;
+			ModelStartSeconds[Idx] = 0.f;
+			continue;
+		}
+
+		FRGTrajectoryModelInput Input = BaseInput;
+		Input.Location = DivergeLocation;
+		Input.Rotation = DivergeRotation;
+		Input.Velocity = DivergeVelocity;
+		Input.YawRate = 0.f;
+		Input.Horizon = TrajectorySimSeconds - DivergeSeconds;
+
+		switch (Hypotheses[Idx])
+		{
+		case ERGTrajectoryHypothesis::Stop:
+			Input.Acceleration = FVector::ZeroVector;
+			break;
+		case ERGTrajectoryHypothesis::TurnLeft:
+			Input.Acceleration = Heading.RotateAngleAxis(-HypothesisTurnAngle, FVector::UpVector) * TurnAccelerationSize;
+			break;
+		case ERGTrajectoryHypothesis::TurnRight:
+			Input.Acceleration = Heading.RotateAngleAxis(HypothesisTurnAngle, FVector::UpVector) * TurnAccelerationSize;
+			break;
+		default:
+			break;
+		}
+
+		Models[Idx].Initialize(Input);
+		ModelStartSeconds[Idx] = DivergeSeconds;
+	}
+
+	// Fill in each sample time for every hypothesis at once, so the lanes are written side by side.
+	for (int32 SampleIdx = NumShared; SampleIdx < TotalSimulatedSamples; SampleIdx++)
+	{
+		const float Seconds = OutSet.GetSampleSeconds(SampleIdx);
+		for (int32 Idx = 0; Idx < Models.Num(); Idx++)
+		{
+			Models[Idx].Evaluate(Seconds - ModelStartSeconds[Idx], Location, Velocity, Rotation);
+			OutSet.SetSample(Idx, SampleIdx, Location, Velocity, Rotation.Yaw);
+		}
+	}
+}
+
+void URGTrajectoryMovementComponent::FollowPredictionPath(const FTransform& FromOrigin, TArrayView<FRGMovementSample> Samples) const
+{
+	const FRGTrajectorySnapshot& Snapshot = TrajectorySnapshot;
+	const FRGTrajectoryPath* Path = Snapshot.Path.Get();
+	if (Path == nullptr || Samples.IsEmpty()) return;
+
+	double StartProfileDistance;
+	double StartSpeed;
+	Snapshot.PathProfile.Evaluate(Snapshot.PathProfileSeconds, StartProfileDistance, StartSpeed);
+
+	// Path points are on the ground, and the pawn is rarely exactly on the path; carry its offset along with it.
+	int32 Segment = Snapshot.PathSegment;
+	FVector Direction;
+	const FVector Offset = FromOrigin.GetLocation() - Path->Evaluate(Snapshot.PathDistance, Direction, Segment);
+	FRotator Rotation = FromOrigin.Rotator();
+
+	for (FRGMovementSample& Sample : Samples)
+	{
+		double ProfileDistance;
+		double Speed;
+		Snapshot.PathProfile.Evaluate(Snapshot.PathProfileSeconds + Sample.AccumulatedSeconds, ProfileDistance, Speed);
+
+		const FVector Location = Path->Evaluate(Snapshot.PathDistance + ProfileDistance - StartProfileDistance, Direction, Segment) + Offset;
+		Rotation.Yaw = Direction.Rotation().Yaw;
+		const FVector Velocity = Direction * Speed;
+
+		Sample.WorldTransform = FTransform(Rotation, Location);
+		Sample.WorldLinearVelocity = Velocity;
+		Sample.RelativeTransform = Sample.WorldTransform.GetRelativeTransform(FromOrigin);
+		Sample.RelativeLinearVelocity = FromOrigin.InverseTransformVectorNoScale(Velocity);
+	}
+}
+
+void URGTrajectoryMovementComponent::SpliceRootMotion(const FRGTrajectoryModel& Model, const FTransform& FromOrigin,
+	TArrayView<FRGMovementSample> Samples) const
+{
+	const FRGTrajectorySnapshot& Snapshot = TrajectorySnapshot;
+	const FRGRootMotionTable* Table = Snapshot.RootMotionTable.Get();
+	if (Table == nullptr || Samples.IsEmpty()) return;
+
+	const float PlayRate = Snapshot.RootMotionPlayRate;
+	const float StartPosition = Snapshot.RootMotionPosition;
+	const float RemainingSeconds = FMath::Max(Table->GetDuration() - StartPosition, 0.f) / PlayRate;
+
+	FVector StartTranslation;
+	float StartYaw;
+	Table->Evaluate(StartPosition, StartTranslation, StartYaw);
+
+	// The table is relative to the start of the montage; turn it into motion relative to the mesh as it is now,
+	// and then into the world.
+	const FQuat FromMontageStart = FQuat(FVector::UpVector, FMath::DegreesToRadians(-StartYaw));
+	const FTransform& MeshTransform = Snapshot.RootMotionMeshTransform;
+	auto MeshToWorld = [&](const FVector& MeshVector)
+	{
+		return FromOrigin.TransformVectorNoScale(MeshTransform.TransformVector(FromMontageStart.RotateVector(MeshVector)));
+	};
+
+	auto EvaluateRootMotion = [&](float Seconds, FVector& OutLocation, FQuat& OutRotation, FVector& OutVelocity)
+	{
+		const float Position = StartPosition + Seconds * PlayRate;
+
+		FVector Translation;
+		float Yaw;
+		Table->Evaluate(Position, Translation, Yaw);
+
+		OutLocation = FromOrigin.GetLocation() + MeshToWorld(Translation - StartTranslation);
+		OutRotation = FromOrigin.GetRotation() * FQuat(FVector::UpVector, FMath::DegreesToRadians(Yaw - StartYaw));
+		OutVelocity = MeshToWorld(Table->EvaluateVelocity(Position)) * PlayRate;
+	};
+
+	bool bHasEndOffset = false;
+	FVector EndOffset = FVector::ZeroVector;
+
+	for (FRGMovementSample& Sample : Samples)
+	{
+		if (Sample.AccumulatedSeconds <= RemainingSeconds)
+		{
+			FVector Location;
+			FQuat Rotation;
+			FVector Velocity;
+			EvaluateRootMotion(Sample.AccumulatedSeconds, Location, Rotation, Velocity);
+
+			Sample.WorldTransform = FTransform(Rotation, Location);
+			Sample.WorldLinearVelocity = Velocity;
+			Sample.RelativeLinearVelocity = FromOrigin.InverseTransformVectorNoScale(Velocity);
+		}
+		else
+		{
+			// Once the montage is over, the model takes back over from wherever root motion left us.
+			if (!bHasEndOffset)
+			{
+				FVector EndLocation;
+				FQuat EndRotation;
+				FVector EndVelocity;
+				EvaluateRootMotion(RemainingSeconds, EndLocation, EndRotation, EndVelocity);
+
+				EndOffset = EndLocation - Model.MakeSample(RemainingSeconds, FromOrigin).WorldTransform.GetLocation();
+				bHasEndOffset = true;
+			}
+
+			Sample.WorldTransform.AddToTranslation(EndOffset);
+		}
+
+		Sample.RelativeTransform = Sample.WorldTransform.GetRelativeTransform(FromOrigin);
+	}
+}
+
+void URGTrajectoryMovementComponent::BuildTrajectoryModel(const FTransform& FromOrigin, FRGTrajectoryModel& OutModel) const
+{
+	FRGTrajectoryModelInput Input;
+	BuildTrajectoryModelInput(FromOrigin, Input);
+	OutModel.Initialize(Input);
+}
+
+void URGTrajectoryMovementComponent::BuildTrajectoryModelInput(const FTransform& FromOrigin, FRGTrajectoryModelInput& Input) const
+{
+	FRotator RotationVelocity;
+	FVector PredictedAcceleration;
+	GetCurrentAccelerationRotationVelocityFromHistory(PredictedAcceleration, RotationVelocity);
+
+	const FRGTrajectorySnapshot& Snapshot = TrajectorySnapshot;
+	const FVector CurrentVelocity = Snapshot.LinearVelocity;
+	if (!Snapshot.bInputPresentWithGrace)
+	{
+		// No input means we're going to brake, whatever our acceleration was a moment ago.
+		PredictedAcceleration = FVector::ZeroVector;
+	}
+	else if (!Snapshot.EffectiveAcceleration.IsNearlyZero())
+	{
+		PredictedAcceleration = Snapshot.EffectiveAcceleration;
+	}
+	else if (PredictedAcceleration.IsNearlyZero())
+	{
+		// Holding a steady course; keep driving along our input at full acceleration.
+		const FVector InputDirection = Snapshot.InputDirection.IsNearlyZero() ? CurrentVelocity.GetSafeNormal2D() : Snapshot.InputDirection;
+		PredictedAcceleration = InputDirection * TrajectoryMaxAcceleration;
+	}
+
+	Input = FRGTrajectoryModelInput();
+	if (Snapshot.MovementMode == EGMC_MovementMode::Airborne)
+	{
+		Input.Type = ERGTrajectoryModelType::Ballistic;
+		Input.Gravity = FVector(0.f, 0.f, Snapshot.GravityZ);
+		Input.AirControl = AirborneTrajectoryControl;
+		Input.bHasLandingHeight = bHasGroundedHeight;
+		Input.LandingHeight = LastGroundedHeight;
+	}
+	else if (Snapshot.MovementMode == EGMC_MovementMode::Swimming)
+	{
+		Input.Type = ERGTrajectoryModelType::Drag;
+		Input.Drag = SwimmingTrajectoryDrag;
+	}
+
+	Input.Location = FromOrigin.GetLocation();
+	Input.Rotation = FromOrigin.GetRotation().Rotator();
+	Input.Velocity = CurrentVelocity;
+	Input.Acceleration = PredictedAcceleration;
+	Input.YawRate = RotationVelocity.Yaw;
+	Input.YawRateDecay = TrajectoryTurnRateDecay;
+	Input.BrakingDeceleration = Snapshot.BrakingDeceleration;
+	Input.Friction = Snapshot.GroundFriction;
+	Input.MaxSpeed = Snapshot.MaxSpeed;
+	Input.Horizon = TrajectorySimSeconds;
+}
+
+void URGTrajectoryMovementComponent::UpdateTrajectoryPrediction()
+{
+	PredictMovementFutureInto(PredictedTrajectory.Samples, TrajectorySnapshot.ActorTransform, true);
+	if (bAdaptiveTrajectory)
+	{
+		PredictedTrajectory.Simplify(AdaptivePositionTolerance, AdaptiveRotationTolerance, AdaptiveSpeedTolerance);
+	}
+	PredictionRevision++;
+}
+
+FRGMovementSample URGTrajectoryMovementComponent::GetMovementSampleFromCurrentState() const
+{
+	FTransform CurrentTransform = TrajectorySnapshot.ActorTransform;
+	CurrentTransform.SetLocation(TrajectorySnapshot.LowerBound);
+
+	FRGMovementSample Result = FRGMovementSample(CurrentTransform, TrajectorySnapshot.LinearVelocity);
+	Result.ActorWorldRotation = TrajectorySnapshot.ActorTransform.Rotator();
+	if (!LastMovementSample.IsZeroSample())
+	{
+		Result.ActorDeltaRotation = Result.ActorWorldRotation - LastMovementSample.ActorWorldRotation;
+	}
+
+	return Result;
+}
+
+void URGTrajectoryMovementComponent::AddNewMovementSample(const FRGMovementSample& NewSample)
+{
+	const double Time = TrajectorySnapshot.Time;
+
+	// A sample at or before the end of the history supersedes whatever we had recorded from that point on.
+	if (!MovementHistory.IsEmpty() && MovementHistory.Last().Time >= Time)
+	{
+		while (!MovementHistory.IsEmpty() && MovementHistory.Last().Time >= Time)
+		{
+			MovementHistory.PopBack();
+		}
+		SyncToHistoryTail();
+	}
+
+	// Everything from before a break goes first.
+	while (!MovementHistory.IsEmpty() && MovementHistory.First().Sequence < HistoryBreakSequence)
+	{
+		MovementHistory.PopFront();
+	}
+
+	const FRGMovementSample StoredSample = ToHistorySpace(NewSample);
+	if (!MovementHistory.IsEmpty())
+	{
+		// A jump our velocity can't account for is a teleport, even if it hasn't been reported as one yet; it
+		// mustn't be read as movement.
+		if (HistoryTeleportDistance > 0.f)
+		{
+			const FVector ExpectedLocation = LastMovementSample.WorldTransform.GetLocation() +
+				LastMovementSample.WorldLinearVelocity * (Time - MovementHistory.Last().Time);
+			if (FVector::DistSquared(NewSample.WorldTransform.GetLocation(), ExpectedLocation) > FMath::Square(HistoryTeleportDistance))
+			{
+				MotionEstimator.MarkDiscontinuity();
+			}
+		}
+
+		const float DeltaDistance = NewSample.DistanceFrom(LastMovementSample);
+		CullMovementSampleHistory(FMath::IsNearlyZero(DeltaDistance), StoredSample, Time);
+	}
+
+	MotionEstimator.SmoothingTime = TrajectoryEstimatorSmoothingTime;
+	MotionEstimator.AccelerationSmoothingTime = TrajectoryEstimatorSmoothingTime * 2.f;
+	MotionEstimator.Update(Time, StoredSample.WorldTransform.GetLocation(), StoredSample.WorldLinearVelocity, StoredSample.ActorWorldRotation, true);
+
+	FRGTrajectoryHistoryEntry Entry;
+	Entry.Sequence = NextHistorySequence++;
+	Entry.Time = Time;
+	Entry.Sample = StoredSample;
+	Entry.Estimator = MotionEstimator;
+
+	// An adaptive history only keeps the last entry if the segment can't simply be stretched to the new one.
+	if (bAdaptiveTrajectory)
+	{
+		if (CanReplaceHistoryTail(Entry))
+		{
+			AdaptiveHistoryWindow.Add(FRGTrajectoryKeyframe(MovementHistory.Last()));
+			MovementHistory.PopBack();
+		}
+		else
+		{
+			AdaptiveHistoryWindow.Reset();
+		}
+		AdaptiveHistoryTailSequence = Entry.Sequence;
+	}
+
+	// Samples are stored as-is; nothing already in the history needs touching to add one. Once the buffer is at
+	// MaxTrajectorySamples, the oldest sample is overwritten, so it goes to the long history first.
+	if (MovementHistory.IsFull())
+	{
+		ArchiveHistoryEntry(MovementHistory.First());
+	}
+
+	MovementHistory.Emplace(MoveTemp(Entry));
+
+	LastMovementSample = NewSample;
+}
+
+bool URGTrajectoryMovementComponent::CanReplaceHistoryTail(const FRGTrajectoryHistoryEntry& NewEntry) const
+{
+	if (MovementHistory.Num() < 2 || MovementHistory.Last().Sequence != AdaptiveHistoryTailSequence ||
+		AdaptiveHistoryWindow.Num() >= FRGTrajectoryKeyframeHistory::MaxWindow)
+	{
+		return false;
+	}
+
+	const FRGTrajectoryKeyframe From(MovementHistory[MovementHistory.Num() - 2]);
+	const FRGTrajectoryKeyframe To(NewEntry);
+	const float PositionToleranceSquared = FMath::Square(AdaptivePositionTolerance);
+	const float RotationToleranceRadians = FMath::DegreesToRadians(AdaptiveRotationTolerance);
+	const float SpeedToleranceSquared = FMath::Square(AdaptiveSpeedTolerance);
+
+	const auto IsWithinTolerance = [&](const FRGTrajectoryKeyframe& Point)
+	{
+		const FRGTrajectoryKeyframe Interpolated = FRGTrajectoryKeyframe::Interpolate(From, To, Point.Time);
+		return FVector::DistSquared(Interpolated.Location, Point.Location) <= PositionToleranceSquared &&
+			Interpolated.Rotation.AngularDistance(Point.Rotation) <= RotationToleranceRadians &&
+			FVector::DistSquared(Interpolated.Velocity, Point.Velocity) <= SpeedToleranceSquared;
+	};
+
+	if (!IsWithinTolerance(FRGTrajectoryKeyframe(MovementHistory.Last()))) return false;
+
+	for (const FRGTrajectoryKeyframe& Point : AdaptiveHistoryWindow)
+	{
+		if (!IsWithinTolerance(Point)) return false;
+	}
+
+	return true;
+}
+
+namespace
+{
+	/// True if a stored sample is motionless and exactly where the latest sample is, making it redundant.
+	bool IsStationaryDuplicate(const FRGMovementSample& Sample, const FRGMovementSample& LatestSample)
+	{
+		return Sample.WorldLinearVelocity.IsNearlyZero() && Sample.WorldTransform.Equals(LatestSample.WorldTransform);
+	}
+}
+
+void URGTrajectoryMovementComponent::CullMovementSampleHistory(bool bIsNearlyZero, const FRGMovementSample& LatestSample, double LatestTime)
+{
+	const FRGTrajectoryHistoryEntry& FirstEntry = MovementHistory.First();
+	const float FirstSampleTime = FirstEntry.Time - LatestTime;
+
+	// While we're motionless, a time horizon lets the history keep decaying uniformly; once moving, it's cleared.
+	const bool bStopped = bIsNearlyZero && !IsStationaryDuplicate(FirstEntry.Sample, LatestSample);
+	EffectiveTrajectoryTimeDomain = RGTrajectoryCore::UpdateHistoryTimeDomain(EffectiveTrajectoryTimeDomain, bStopped, FirstSampleTime);
+
+	// We don't need duplicate zero motion samples, they just clutter the history. They can only pile up at the end.
+	if (LatestSample.IsZeroSample())
+	{
+		while (!MovementHistory.IsEmpty() && IsStationaryDuplicate(MovementHistory.Last().Sample, LatestSample))
+		{
+			MovementHistory.PopBack();
+		}
+	}
+
+	// The history is in time order, so anything too old is at the front.
+	while (!MovementHistory.IsEmpty())
+	{
+		// If a time horizon is in effect, this also prunes everything before our zero motion moment.
+		const float SampleTime = MovementHistory.First().Time - LatestTime;
+		if (!RGTrajectoryCore::ShouldCullHistorySample(SampleTime, TrajectoryHistorySeconds, EffectiveTrajectoryTimeDomain)) break;
+		ArchiveHistoryEntry(MovementHistory.First());
+		MovementHistory.PopFront();
+	}
+}
+
+void URGTrajectoryMovementComponent::UpdateTrajectoryAnimData()
+{
+	FRGTrajectoryAnimData& Data = TrajectoryAnimData;
+	const FRGTrajectorySnapshot& Snapshot = TrajectorySnapshot;
+
+	Data.bIsStopping = bTrajectoryIsStopping;
+	Data.StopPoint = PredictedStopPoint;
+	Data.bIsPivoting = bTrajectoryIsPivoting;
+	Data.PivotPoint = PredictedPivotPoint;
+	Data.bIsLanding = bTrajectoryIsLanding;
+	Data.LandingPoint = PredictedLandingPoint;
+	Data.LandingSeconds = PredictedLandingSeconds;
+	Data.bInputPresent = Snapshot.bInputPresent;
+	Data.InputVelocityOffset = Snapshot.InputVelocityOffset;
+	Data.EffectiveAcceleration = Snapshot.EffectiveAcceleration;
+	Data.LinearVelocity = Snapshot.LinearVelocity;
+
+	// Reset rather than Empty, so that the array keeps its allocation from frame to frame.
+	Data.bHistoryDiscontinuity = bHistoryDiscontinuityPending;
+	bHistoryDiscontinuityPending = false;
+
+	Data.Samples.Reset();
+	Data.PresentIndex = INDEX_NONE;
+	if (!bTrajectoryEnabled) return;
+
+	const FTransform& Origin = Snapshot.ActorTransform;
+	const auto AddSample = [&](const FRGMovementSample& Sample)
+	{
+		FRGTrajectoryAnimSample& AnimSample = Data.Samples.AddDefaulted_GetRef();
+		AnimSample.Seconds = Sample.AccumulatedSeconds;
+		AnimSample.Position = Origin.InverseTransformPositionNoScale(Sample.WorldTransform.GetLocation());
+		AnimSample.Yaw = Origin.InverseTransformRotation(Sample.WorldTransform.GetRotation()).Rotator().Yaw;
+		AnimSample.Velocity = Origin.InverseTransformVectorNoScale(Sample.WorldLinearVelocity);
+
+		if (Data.PresentIndex == INDEX_NONE && Sample.AccumulatedSeconds >= 0.f)
+		{
+			Data.PresentIndex = Data.Samples.Num() - 1;
+		}
+	};
+
+	if (bPrecalculateFutureTrajectory)
+	{
+		Data.Samples.Reserve(PredictedTrajectory.Samples.Num());
+		for (const FRGMovementSample& Sample : PredictedTrajectory.Samples)
+		{
+			AddSample(Sample);
+		}
+	}
+	else
+	{
+		Data.Samples.Reserve(MovementHistory.Num());
+		for (const FRGTrajectoryHistoryEntry& Entry : MovementHistory)
+		{
+			if (Entry.Sequence < HistoryBreakSequence) continue;
+			AddSample(ResolveHistorySample(Entry, MovementHistory.Last()));
+		}
+	}
+}
+
+void URGTrajectoryMovementComponent::GetCurrentAccelerationRotationVelocityFromHistory(FVector& OutAcceleration,
+	FRotator& OutRotationVelocity) const
+{
+	if (!MotionEstimator.IsValid())
+	{
+		OutAcceleration = FVector::ZeroVector;
+		OutRotationVelocity = FRotator::ZeroRotator;
+		return;
+	}
+
+	OutAcceleration = HistoryAnchor.TransformVectorNoScale(MotionEstimator.GetAcceleration());
+	OutRotationVelocity = MotionEstimator.GetRotationVelocity();
+}
+
+void URGTrajectoryMovementComponent::UpdateMovementSamples_Implementation()
+{
+	if (MovementHistory.IsEmpty() || TrajectorySnapshot.Time - MovementHistory.Last().Time > SMALL_NUMBER)
+	{
+		AddNewMovementSample(GetMovementSampleFromCurrentState());
+	}	
+}
+
+bool URGTrajectoryMovementComponent::GetPredictionBlock(FVector& OutLocation, FVector& OutNormal, float& OutSeconds) const
+{
+	OutLocation = PredictionBlock.Location;
+	OutNormal = PredictionBlock.Normal;
+	OutSeconds = PredictionBlock.Seconds;
+	return PredictionBlock.bBlocked;
+}
+
+void URGTrajectoryMovementComponent::ApplyPredictionCollision()
+{
+	if (!PredictionBlock.bBlocked) return;
+
+	// Anything on the far side of the blocking plane can't be reached; slide it back onto the plane.
+	const FVector& PlaneLocation = PredictionBlock.Location;
+	const FVector& PlaneNormal = PredictionBlock.Normal;
+
+	const auto ClipLocation = [&](FVector& Location) -> bool
+	{
+		const float Penetration = (Location - PlaneLocation) | PlaneNormal;
+		if (Penetration >= 0.f) return false;
+
+		Location -= PlaneNormal * Penetration;
+		return true;
+	};
+
+	if (bPrecalculateFutureTrajectory)
+	{
+		const FTransform& Origin = TrajectorySnapshot.ActorTransform;
+		for (FRGMovementSample& Sample : PredictedTrajectory.Samples)
+		{
+			if (Sample.AccumulatedSeconds <= 0.f) continue;
+
+			FVector Location = Sample.WorldTransform.GetLocation();
+			if (!ClipLocation(Location)) continue;
+
+			FVector Velocity = Sample.WorldLinearVelocity;
+			const float IntoPlane = Velocity | PlaneNormal;
+			if (IntoPlane < 0.f)
+			{
+				Velocity -= PlaneNormal * IntoPlane;
+			}
+
+			Sample.WorldTransform.SetLocation(Location);
+			Sample.WorldLinearVelocity = Velocity;
+			Sample.RelativeTransform = Sample.WorldTransform.GetRelativeTransform(Origin);
+			Sample.RelativeLinearVelocity = Origin.InverseTransformVectorNoScale(Velocity);
+		}
+	}
+
+	const FVector ActorLocation = TrajectorySnapshot.ActorTransform.GetLocation();
+	FVector StopLocation = ActorLocation + PredictedStopPoint;
+	if (bTrajectoryIsStopping && ClipLocation(StopLocation))
+	{
+		PredictedStopPoint = StopLocation - ActorLocation;
+	}
+
+	FVector PivotLocation = ActorLocation + PredictedPivotPoint;
+	if (bTrajectoryIsPivoting && ClipLocation(PivotLocation))
+	{
+		PredictedPivotPoint = PivotLocation - ActorLocation;
+	}
+
+	FVector LandingLocation = ActorLocation + PredictedLandingPoint;
+	if (bTrajectoryIsLanding && ClipLocation(LandingLocation))
+	{
+		PredictedLandingPoint = LandingLocation - ActorLocation;
+	}
+}
+
+void URGTrajectoryMovementComponent::IssuePredictionSweeps()
+{
+	// Wait for the previous set to come back before issuing more; results are applied the frame after.
+	if (!PendingPredictionSweeps.IsEmpty()) return;
+
+	const UPrimitiveComponent* Primitive = UpdatedPrimitive;
+	UWorld* World = GetWorld();
+	if (!IsValid(Primitive) || !IsValid(World)) return;
+
+	if (RGTrajectory::PredictionSweepBudgetFrame != GFrameCounter)
+	{
+		RGTrajectory::PredictionSweepBudgetFrame = GFrameCounter;
+		RGTrajectory::PredictionSweepsThisFrame = 0;
+	}
+
+	const int32 GlobalBudget = CVarMaxPredictionSweepsPerFrame.GetValueOnGameThread() - RGTrajectory::PredictionSweepsThisFrame;
+	const int32 Budget = FMath::Min(MaxPredictionSweepsPerFrame, GlobalBudget);
+	if (Budget <= 0) return;
+
+	// The sweeps start at the current sample and cover the future portion of the prediction.
+	const TArray<FRGMovementSample>& Samples = PredictedTrajectory.Samples;
+	const int32 FirstIdx = Samples.IndexOfByPredicate([](const FRGMovementSample& Sample) { return Sample.AccumulatedSeconds >= 0.f; });
+	if (FirstIdx == INDEX_NONE) return;
+
+	const int32 FutureCount = Samples.Num() - 1 - FirstIdx;
+	if (FutureCount < 1) return;
+
+	const int32 NumSweeps = FMath::Min(Budget, FutureCount);
+	const FCollisionShape Shape = Primitive->GetCollisionShape(RGTrajectory::PredictionSweepInflation);
+	const FQuat Rotation = Primitive->GetComponentQuat();
+	const FCollisionQueryParams Params(SCENE_QUERY_STAT(RGTrajectoryPredictionSweep), false, GetOwner());
+
+	PendingPredictionBlock = FPredictionBlock();
+
+	for (int32 SweepIdx = 0; SweepIdx < NumSweeps; SweepIdx++)
+	{
+		const FRGMovementSample& Start = Samples[FirstIdx + SweepIdx * FutureCount / NumSweeps];
+		const FRGMovementSample& End = Samples[FirstIdx + (SweepIdx + 1) * FutureCount / NumSweeps];
+
+		FPredictionSweep& Sweep = PendingPredictionSweeps.AddDefaulted_GetRef();
+		Sweep.StartSeconds = Start.AccumulatedSeconds;
+		Sweep.EndSeconds = End.AccumulatedSeconds;
+		Sweep.Handle = World->AsyncSweepByChannel(EAsyncTraceType::Single, Start.WorldTransform.GetLocation(),
+			End.WorldTransform.GetLocation(), Rotation, PredictionCollisionChannel, Shape, Params,
+			FCollisionResponseParams::DefaultResponseParam, &PredictionSweepDelegate);
+	}
+
+	RGTrajectory::PredictionSweepsThisFrame += NumSweeps;
+}
+
+void URGTrajectoryMovementComponent::OnPredictionSweepComplete(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	const int32 SweepIdx = PendingPredictionSweeps.IndexOfByPredicate([&](const FPredictionSweep& Sweep) { return Sweep.Handle == Handle; });
+	if (SweepIdx == INDEX_NONE) return;
+
+	const FPredictionSweep Sweep = PendingPredictionSweeps[SweepIdx];
+	PendingPredictionSweeps.RemoveAtSwap(SweepIdx);
+
+	for (const FHitResult& Hit : Datum.OutHits)
+	{
+		if (!Hit.bBlockingHit || Hit.bStartPenetrating || Hit.ImpactNormal.Z > RGTrajectory::WalkableNormalZ) continue;
+
+		// We only predict grounded movement, so only the horizontal part of the normal matters.
+		const FVector Normal = FVector(Hit.Normal.X, Hit.Normal.Y, 0.f).GetSafeNormal();
+		if (Normal.IsZero()) continue;
+
+		const float HitSeconds = FMath::Lerp(Sweep.StartSeconds, Sweep.EndSeconds, Hit.Time);
+		if (!PendingPredictionBlock.bBlocked || HitSeconds < PendingPredictionBlock.Seconds)
+		{
+			PendingPredictionBlock.bBlocked = true;
+			PendingPredictionBlock.Seconds = HitSeconds;
+			PendingPredictionBlock.Location = Hit.Location;
+			PendingPredictionBlock.Normal = Normal;
+		}
+		break;
+	}
+
+	if (PendingPredictionSweeps.IsEmpty())
+	{
+		PredictionBlock = PendingPredictionBlock;
+	}
+}
+
+void URGTrajectoryMovementComponent::EnableRagdoll()
+{
+	bWantsRagdoll = true;
+}
+
+void URGTrajectoryMovementComponent::DisableRagdoll()
+{
+	bWantsRagdoll = false;
+}
+
+void URGTrajectoryMovementComponent::SetRagdollActive(bool bActive)
+{
+	if (IsNetworkedServer()) return;
+	
+	if (bActive)
+	{
+		if (PreviousRelativeMeshLocation.IsZero())
+		{
+			PreviousRelativeMeshLocation = SkeletalMesh->GetRelativeLocation();
+			PreviousRelativeMeshRotation = SkeletalMesh->GetRelativeRotation();
+		}
+		HaltMovement();
+	}
+	else if (bRagdollApplied)
+	{
+		// Start looking for somewhere to stand now, so that the answer is likely in by the time our turn comes up.
+		IssueRagdollFloorTrace();
+	}
+
+	bEnablePhysicsInteraction = !bActive;
+	bFirstRagdollTick = bActive;
+	bResetMesh = !bActive;
+}
+
+void URGTrajectoryMovementComponent::ProcessRagdollTransition()
+{
+	bRagdollTransitionQueued = false;
+
+	// Putting the mesh back is its own step, taking its own turn in the queue, so that a disable's cost is spread
+	// over two turns rather than landing all at once.
+	if (bRagdollReattachPending)
+	{
+		FinishRagdollDisable();
+		return;
+	}
+
+	if (bResetMesh)
+	{
+		// If we never actually went ragdoll (e.g. it was toggled on and off before our turn came up), there's
+		// nothing to undo, and PreviousCollisionHalfHeight was never captured.
+		if (!bRagdollApplied)
+		{
+			bResetMesh = false;
+			return;
+		}
+
+		// Still waiting on the floor trace; the component queues us again next frame.
+		if (bRagdollFloorTracePending) return;
+
+		ApplyRagdollDisable();
+	}
+	else if (bFirstRagdollTick && GetMovementMode() == GetRagdollMode())
+	{
+		if (bRagdollApplied)
+		{
+			// Asked to get up and then to go ragdoll again before we'd got up; we're still ragdolled, so just
+			// forget about getting up.
+			bFirstRagdollTick = false;
+			CancelRagdollFloorTrace();
+			return;
+		}
+
+		ApplyRagdollEnable();
+	}
+}
+
+void URGTrajectoryMovementComponent::IssueRagdollFloorTrace()
+{
+	CancelRagdollFloorTrace();
+
+	UWorld* World = GetWorld();
+	if (!bRagdollTracked || !IsValid(World)) return;
+
+	const UPrimitiveComponent* CollisionComponent = Cast<UPrimitiveComponent>(UpdatedComponent);
+	const ECollisionChannel Channel = IsValid(CollisionComponent) ? CollisionComponent->GetCollisionObjectType() : ECC_Pawn;
+	const FCollisionQueryParams Params(SCENE_QUERY_STAT(RGTrajectoryRagdollGetUp), false, GetOwner());
+	const FVector TraceEnd = RagdollTrackedLocation - FVector::UpVector * PreviousCollisionHalfHeight * 2.f;
+
+	RagdollFloorTraceHandle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, RagdollTrackedLocation, TraceEnd, Channel,
+		Params, FCollisionResponseParams::DefaultResponseParam, &RagdollFloorTraceDelegate);
+	bRagdollFloorTracePending = RagdollFloorTraceHandle.IsValid();
+}
+
+void URGTrajectoryMovementComponent::CancelRagdollFloorTrace()
+{
+	// There's no cancelling an async trace as such; we just stop listening for it.
+	RagdollFloorTraceHandle = FTraceHandle();
+	bRagdollFloorTracePending = false;
+	bRagdollFloorFound = false;
+}
+
+void URGTrajectoryMovementComponent::OnRagdollFloorTraceComplete(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	if (Handle != RagdollFloorTraceHandle) return;
+
+	bRagdollFloorTracePending = false;
+	for (const FHitResult& Hit : Datum.OutHits)
+	{
+		if (!Hit.bBlockingHit || Hit.bStartPenetrating) continue;
+
+		bRagdollFloorFound = true;
+		RagdollFloorLocation = Hit.ImpactPoint;
+		break;
+	}
+}
+
+void URGTrajectoryMovementComponent::CacheRagdollBodies()
+{
+	RagdollBodyIndices.Reset();
+	RagdollPelvisBodyIndex = INDEX_NONE;
+
+	if (!IsValid(SkeletalMesh)) return;
+
+	const UPhysicsAsset* PhysicsAsset = SkeletalMesh->GetPhysicsAsset();
+	if (!IsValid(PhysicsAsset)) return;
+
+	RagdollPelvisBodyIndex = PhysicsAsset->FindBodyIndex(RagdollPelvisBoneName);
+	for (int32 BodyIdx = 0; BodyIdx < PhysicsAsset->SkeletalBodySetups.Num(); BodyIdx++)
+	{
+		const USkeletalBodySetup* BodySetup = PhysicsAsset->SkeletalBodySetups[BodyIdx];
+		if (!IsValid(BodySetup)) continue;
+
+		if (BodySetup->BoneName == RagdollPelvisBoneName || SkeletalMesh->BoneIsChildOf(BodySetup->BoneName, RagdollPelvisBoneName))
+		{
+			RagdollBodyIndices.Add(BodyIdx);
+		}
+	}
+
+	// Make sure the bodies exist up front, so that going ragdoll only has to flip them to simulated
+	// rather than creating them on the spot.
+	if (!SkeletalMesh->IsPhysicsStateCreated())
+	{
+		SkeletalMesh->bAlwaysCreatePhysicsState = true;
+		SkeletalMesh->RecreatePhysicsState();
+	}
+}
+
+FBodyInstance* URGTrajectoryMovementComponent::GetRagdollPelvisBody() const
+{
+	if (!IsValid(SkeletalMesh) || !SkeletalMesh->Bodies.IsValidIndex(RagdollPelvisBodyIndex)) return nullptr;
+
+	return SkeletalMesh->Bodies[RagdollPelvisBodyIndex];
+}
+
+void URGTrajectoryMovementComponent::ApplyRagdollEnable()
+{
+	bFirstRagdollTick = false;
+
+#if ENABLE_DRAW_DEBUG || WITH_EDITORONLY_DATA
+	// Drawn with the rest of our debug lines by the subsystem.
+	DebugRagdollLaunchStart = GetActorLocation_GMC();
+	DebugRagdollLaunchMarkerExpiry = GetWorld()->GetTimeSeconds() + 1.0;
+#endif
+
+	UPrimitiveComponent* CollisionComponent = Cast<UPrimitiveComponent>(UpdatedComponent);
+	if (IsValid(CollisionComponent))
+	{
+		CollisionComponent->SetCollisionEnabled(ECollisionEnabled::Type::NoCollision);
+	}
+	
+	PreviousCollisionHalfHeight = GetRootCollisionHalfHeight(true);
+	SetRootCollisionHalfHeight(0.1f, false, false);
+
+	// Flip the bodies to simulated and hand the momentum over body by body, using the indices we cached, rather
+	// than walking the hierarchy by name again. The mesh picks up the change in simulation state on its next tick.
+	for (const int32 BodyIdx : RagdollBodyIndices)
+	{
+		if (FBodyInstance* Body = SkeletalMesh->Bodies.IsValidIndex(BodyIdx) ? SkeletalMesh->Bodies[BodyIdx] : nullptr)
+		{
+			Body->SetInstanceSimulatePhysics(true, false, true);
+			Body->SetLinearVelocity(RagdollLinearVelocity, false);
+		}
+	}
+
+	bRagdollApplied = true;
+	StartRagdollTracking();
+}
+
+void URGTrajectoryMovementComponent::ApplyRagdollDisable()
+{
+	UPrimitiveComponent* CollisionComponent = Cast<UPrimitiveComponent>(UpdatedComponent);
+	if (IsValid(CollisionComponent))
+	{
+		CollisionComponent->SetCollisionEnabled(ECollisionEnabled::Type::QueryAndPhysics);
+		SetRootCollisionHalfHeight(PreviousCollisionHalfHeight, true, false);
+	}
+
+	// Get up wherever the ragdoll ended up, using the physics thread's last report rather than reading bones back.
+	// The pelvis lies about on the floor, so stand the restored collision on the floor the trace found beneath it,
+	// rather than centering it on the pelvis and leaving its bottom half in the ground.
+	if (bRagdollTracked && IsValid(UpdatedComponent))
+	{
+		const FVector GetUpLocation = bRagdollFloorFound ? RagdollFloorLocation + FVector::UpVector * PreviousCollisionHalfHeight : RagdollTrackedLocation;
+		SetActorLocation_GMC(GetUpLocation);
+		SetActorRotation_GMC(RagdollGetUpRotation);
+	}
+	CancelRagdollFloorTrace();
+	StopRagdollTracking();
+
+	// Only the bodies we set simulating need to go back, and those we have the indices for; any which the physics
+	// asset itself marks as simulated carry on as they were.
+	for (const int32 BodyIdx : RagdollBodyIndices)
+	{
+		if (FBodyInstance* Body = SkeletalMesh->Bodies.IsValidIndex(BodyIdx) ? SkeletalMesh->Bodies[BodyIdx] : nullptr)
+		{
+			const UBodySetup* BodySetup = Body->GetBodySetup();
+			Body->SetInstanceSimulatePhysics(BodySetup && BodySetup->PhysicsType == EPhysicsType::PhysType_Simulated, false, true);
+		}
+	}
+
+	bResetMesh = false;
+	bRagdollApplied = false;
+	bRagdollReattachPending = true;
+}
+
+void URGTrajectoryMovementComponent::FinishRagdollDisable()
+{
+	bRagdollReattachPending = false;
+
+	SkeletalMesh->AttachToComponent(GetPawnOwner()->GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+	SkeletalMesh->SetRelativeLocationAndRotation(PreviousRelativeMeshLocation, PreviousRelativeMeshRotation, false, nullptr, ETeleportType::ResetPhysics);
+}
+
+void URGTrajectoryMovementComponent::StartRagdollTracking()
+{
+	if (RagdollTrackingCallback || !GetRagdollPelvisBody()) return;
+
+	FPhysScene* PhysScene = GetWorld()->GetPhysicsScene();
+	Chaos::FPhysicsSolver* Solver = PhysScene ? PhysScene->GetSolver() : nullptr;
+	if (!Solver) return;
+
+	RagdollTrackingCallback = Solver->CreateAndRegisterSimCallbackObject_External<FRGRagdollTrackingCallback>();
+	bRagdollTracked = false;
+}
+
+void URGTrajectoryMovementComponent::StopRagdollTracking()
+{
+	if (RagdollTrackingCallback)
+	{
+		FPhysScene* PhysScene = GetWorld() ? GetWorld()->GetPhysicsScene() : nullptr;
+		if (Chaos::FPhysicsSolver* Solver = PhysScene ? PhysScene->GetSolver() : nullptr)
+		{
+			Solver->UnregisterAndFreeSimCallbackObject_External(RagdollTrackingCallback);
+		}
+		RagdollTrackingCallback = nullptr;
+	}
+
+	bRagdollTracked = false;
+}
+
+void URGTrajectoryMovementComponent::UpdateRagdollTracking()
+{
+	const FBodyInstance* PelvisBody = GetRagdollPelvisBody();
+	if (!PelvisBody)
+	{
+		StopRagdollTracking();
+		return;
+	}
+
+	// Tell the physics thread what to watch for its next step...
+	if (FRGRagdollTrackingInput* Input = RagdollTrackingCallback->GetProducerInputData_External())
+	{
+		Input->PelvisProxy = PelvisBody->GetPhysicsActorHandle();
+	}
+
+	// ... and take the newest of whatever it has reported since last frame.
+	bool bUpdated = false;
+	while (Chaos::TSimCallbackOutputHandle<FRGRagdollTrackingOutput> Output = RagdollTrackingCallback->PopOutputData_External())
+	{
+		if (!Output->bValid) continue;
+
+		RagdollTrackedLocation = Output->Location;
+		RagdollTrackedVelocity = Output->LinearVelocity;
+		RagdollTrackedRotation = Output->Rotation;
+		bUpdated = true;
+	}
+
+	if (!bUpdated) return;
+	bRagdollTracked = true;
+
+	// Face away from the head when lying on our back, towards it when lying on our front, so that the get-up
+	// animations line up with the body.
+	bRagdollFaceUp = RagdollTrackedRotation.RotateVector(RagdollPelvisFrontAxis).Z > 0.f;
+	const FVector SpineDirection = RagdollTrackedRotation.RotateVector(RagdollPelvisSpineAxis).GetSafeNormal2D();
+	if (!SpineDirection.IsNearlyZero())
+	{
+		RagdollGetUpRotation = (bRagdollFaceUp ? -SpineDirection : SpineDirection).Rotation();
+	}
+
+	// Through GMC, so that its state agrees with where the root actually is.
+	if (bFollowRagdollWithRoot && IsValid(UpdatedComponent))
+	{
+		SetActorLocation_GMC(RagdollTrackedLocation);
+	}
+}
@@ -12,13 +12,156 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
 #include "GMCOrganicMovementComponent.h"
+#include "RGMotionEstimator.h"
 #include "RGMovementSample.h"
-#include "Containers/RingBuffer.h"
+#include "RGRootMotionTable.h"
+#include "RGTrajectoryAnimData.h"
+#include "RGTrajectoryBuffer.h"
+#include "RGTrajectoryHistory.h"
+#include "RGTrajectoryHypotheses.h"
+#include "RGTrajectoryModel.h"
+#include "RGTrajectoryPath.h"
 #include "RGTrajectoryMovementComponent.generated.h"
 
+class FRGRagdollTrackingCallback;
+class UAnimMontage;
+class USplineComponent;
+struct FNavigationPath;
+struct FRGTrajectoryMassHistoryFragment;
+struct FRGTrajectoryMassStateFragment;
+class URGTrajectoryMovementComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FRGTrajectoryDiscontinuitySignature, bool, bHistoryCarried);
+
+/// A change in what the trajectory component predicts, or in its input.
+UENUM(BlueprintType)
+enum class ERGTrajectoryEvent : uint8
+{
+	StopBegin,
+	StopEnd,
+	PivotBegin,
+	PivotEnd,
+	StartMoving,
+	InputStarted,
+	InputStopped
+};
+
+USTRUCT(BlueprintType)
+struct ROOICORE_API FRGTrajectoryEventData
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	ERGTrajectoryEvent Event { ERGTrajectoryEvent::StopBegin };
+
+	/// For stop and pivot begin events, the predicted point, relative to the actor; otherwise zero.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FVector Point { 0.f };
+
+	/// For stop and pivot begin events, the predicted seconds until the stop or change of direction.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float Seconds { 0.f };
+};
+
+/// What the server sends simulated proxies to extrapolate from: its state when it sent the update, the GMC time
+/// it was sent at, and the model parameters a proxy can't work out for itself from sparse updates.
+USTRUCT()
+struct ROOICORE_API FRGProxyExtrapolationState
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize10 Location { FVector::ZeroVector };
+
+	UPROPERTY()
+	FVector_NetQuantize10 Velocity { FVector::ZeroVector };
+
+	UPROPERTY()
+	FVector_NetQuantize10 Acceleration { FVector::ZeroVector };
+
+	UPROPERTY()
+	float Yaw { 0.f };
+
+	UPROPERTY()
+	float YawRate { 0.f };
+
+	UPROPERTY()
+	double Time { 0.0 };
+};
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FRGTrajectoryEventNativeSignature, URGTrajectoryMovementComponent*, const FRGTrajectoryEventData&);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FRGTrajectoryEventSignature, const FRGTrajectoryEventData&, EventData);
+
 static EGMC_MovementMode MovementMode_Ragdoll = EGMC_MovementMode::Custom1;
 
+/// The GMC state trajectory work needs, captured on the game thread once GMC has finished its tick. The
+/// trajectory tick only ever reads this, so that it's free to run on a worker thread.
+struct ROOICORE_API FRGTrajectorySnapshot
+{
+	/// GMC's synchronized time, which history is keyed on.
+	double Time { 0.0 };
+	FTransform ActorTransform { FTransform::Identity };
+	FVector LowerBound { 0.f };
+	FVector LinearVelocity { 0.f };
+	EGMC_MovementMode MovementMode { EGMC_MovementMode::Grounded };
+
+	bool bInputPresent { false };
+	bool bInputPresentWithGrace { false };
+	bool bInputAndVelocityDiffer { false };
+	float InputVelocityOffset { 0.f };
+	FVector EffectiveAcceleration { 0.f };
+
+	/// Horizontal direction of input, or zero if there's none.
+	FVector InputDirection { 0.f };
+
+	float BrakingDeceleration { 0.f };
+	float GroundFriction { 0.f };
+	float MaxSpeed { 0.f };
+	float GravityZ { 0.f };
+
+	/// The baked root motion of the montage currently driving the pawn, if any, and how far into it we are.
+	TSharedPtr<const FRGRootMotionTable> RootMotionTable;
+	float RootMotionPosition { 0.f };
+	float RootMotionPlayRate { 1.f };
+
+	/// The mesh's rotation and scale relative to the actor; root motion is expressed in mesh space.
+	FTransform RootMotionMeshTransform { FTransform::Identity };
+
+	/// The path the pawn is following, if any, how far along it the pawn is, and its predicted speed along it.
+	TSharedPtr<const FRGTrajectoryPath> Path;
+	double PathDistance { 0.0 };
+	int32 PathSegment { 0 };
+	RGTrajectoryCore::FPathSpeedProfile PathProfile;
+
+	/// Seconds since PathProfile was built; it's reused for as long as the pawn keeps to it.
+	double PathProfileSeconds { 0.0 };
+};
+
+/// Runs a trajectory component's sampling and prediction separately from the GMC movement tick, so that it
+/// can be given its own tick group and, optionally, run off the game thread.
+USTRUCT()
+struct ROOICORE_API FRGTrajectoryTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	URGTrajectoryMovementComponent* Target { nullptr };
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FRGTrajectoryTickFunction> : public TStructOpsTypeTraitsBase2<FRGTrajectoryTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class ROOICORE_API URGTrajectoryMovementComponent : public UGMC_OrganicMovementCmp
 {
@@ -35,6 +178,43 @@ public:
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void RegisterComponentTickFunctions(bool bRegister) override;
+
+public:
+
+	/// Our history sampling and prediction tick. It always runs after the component's own (GMC) tick; anything
+	/// which reads our trajectory results should add it as a prerequisite.
+	UPROPERTY(EditDefaultsOnly, Category="Movement Trajectory|Tick")
+	FRGTrajectoryTickFunction TrajectoryTick;
+
+	/// If true, the trajectory tick may run on a worker thread. Ignored if UpdateMovementSamples is overridden
+	/// in Blueprint.
+	/// The history and prediction aren't double buffered, so only enable this if nothing on the game thread
+	/// reads or modifies them (e.g. Blueprint, animation, or GMC replays) while the trajectory tick's group is
+	/// running; anything which does should add TrajectoryTick as a prerequisite instead.
+	UPROPERTY(EditDefaultsOnly, Category="Movement Trajectory|Tick")
+	bool bTrajectoryTickOnAnyThread { false };
+
+	/// Performs this frame's trajectory work from the latest snapshot. Called by TrajectoryTick.
+	void TickTrajectory(float DeltaTime);
+
+	/// The GMC state the most recent trajectory work was based on.
+	const FRGTrajectorySnapshot& GetTrajectorySnapshot() const { return TrajectorySnapshot; }
+
+protected:
+
+	/// Captures the GMC state the trajectory tick will work from. Game thread only.
+	void CaptureTrajectorySnapshot();
+
+	/// Captures just the time, transform, velocity and movement mode; enough to record a history sample, without
+	/// touching the path or prediction state. Game thread only.
+	void CaptureMotionSnapshot();
+
+private:
+
+	FRGTrajectorySnapshot TrajectorySnapshot;
 
 public:
 	// GMC Overrides
@@ -75,6 +255,12 @@ public:
 
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category="Movement Trajectory")
 	bool IsTrajectoryDebugEnabled() const;
+
+#if ENABLE_DRAW_DEBUG || WITH_EDITORONLY_DATA
+	/// Appends our debug visualization to a line batch. Called by URGTrajectorySubsystem, which submits every
+	/// pawn's lines together and decides which pawns to draw at all.
+	void AppendDebugLines(TArray<FBatchedLine>& OutLines, int32 SampleStride);
+#endif
 	
 	// Trajectory state functionality (input presence, acceleration synthesis for simulated proxies, etc.)
 #pragma region Trajectory State
@@ -114,6 +300,82 @@ private:
 
 #pragma endregion	
 
+	// Simulated proxy extrapolation along the trajectory model, and server updates sent only when it drifts
+#pragma region Proxy Extrapolation
+public:
+
+	/// If true, the server tracks where simulated proxies would extrapolate us to along the trajectory model, and
+	/// only sends them fresh extrapolation state once that drifts further than the proxy extrapolation tolerances
+	/// from where we really are (or ProxyMaxUpdateInterval passes). Between updates, once GMC has run out of
+	/// state to interpolate, proxies blend over to the extrapolation rather than holding or guessing.
+	///
+	/// The extrapolation state replicates only to simulated proxies, and only when it's resent. The owning
+	/// actor's net update frequency is left alone, so GMC's own proxy state still goes out at that rate; pawns
+	/// no remote client controls can be given a low update frequency, and lean on the extrapolation in between.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Proxy Extrapolation")
+	bool bAdaptiveProxyUpdates { false };
+
+	/// How far, in units, a proxy's extrapolated location may drift before we send an update.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Proxy Extrapolation", meta=(ClampMin=0))
+	float ProxyExtrapolationTolerance { 10.f };
+
+	/// How far, in degrees, a proxy's extrapolated yaw may drift before we send an update.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Proxy Extrapolation", meta=(ClampMin=0))
+	float ProxyExtrapolationRotationTolerance { 10.f };
+
+	/// The longest we'll go without sending an update, however well the extrapolation is doing.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Proxy Extrapolation", meta=(ClampMin=0.01))
+	float ProxyMaxUpdateInterval { 1.f };
+
+	/// How long, in seconds, GMC's own interpolation can be trusted after an update arrives; once the last update
+	/// is older than this, proxies start blending over to the extrapolation.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Proxy Extrapolation", meta=(ClampMin=0))
+	float ProxyInterpolationWindow { 0.1f };
+
+	/// How long, in seconds, proxies take to blend between GMC's state and the extrapolation, either way.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Proxy Extrapolation", meta=(ClampMin=0.01))
+	float ProxyExtrapolationBlendTime { 0.2f };
+
+	/// Where a simulated proxy would extrapolate us to at the given GMC time, from the state and timestamp of
+	/// the last update sent (on the server) or received (on a proxy). Returns false if there's nothing to
+	/// extrapolate from yet.
+	bool ExtrapolateProxyState(double Time, FVector& OutLocation, FVector& OutVelocity, FRotator& OutRotation) const;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+protected:
+
+	/// Server only: compares the proxy extrapolation against where we really are, and sends fresh extrapolation
+	/// state if it's drifted too far.
+	void CheckProxyExtrapolation();
+
+	/// Simulated proxies only: once GMC's state is older than ProxyInterpolationWindow, blends it towards the
+	/// extrapolation, and back again once a fresh update arrives.
+	void ApplyProxyExtrapolation(float DeltaTime);
+
+	/// Simulated proxies only: starts a new extrapolation from the state the server sent.
+	UFUNCTION()
+	void OnRep_ProxyExtrapolationState();
+
+private:
+
+	/// Starts extrapolating from the given model input at the given time.
+	void StartProxyExtrapolation(const FRGTrajectoryModelInput& Input, double Time);
+
+	UPROPERTY(Transient, ReplicatedUsing=OnRep_ProxyExtrapolationState)
+	FRGProxyExtrapolationState ProxyExtrapolationState;
+
+	/// The model proxies are extrapolating with, and the GMC time it starts from (negative if none).
+	FRGTrajectoryModel ProxyExtrapolationModel;
+	double ProxyExtrapolationStartTime { -1.0 };
+
+	/// On proxies, the world time the last update arrived at, and how far we're currently blended over to the
+	/// extrapolation, from zero (GMC's state) to one (the extrapolation).
+	double ProxyExtrapolationReceivedAt { -1.0 };
+	float ProxyExtrapolationBlend { 0.f };
+
+#pragma endregion
+
 	// Stop/pivot point prediction, for distance matching animation.
 #pragma region Stop/Pivot Prediction
 public:
@@ -142,11 +404,22 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Movement Trajectory|Precalculations")
 	bool bPrecalculateDistanceMatches { true };
 
+	/// Calls the landing prediction logic; the result will be cached in the PredictedLandingPoint and
+	/// TrajectoryIsLanding properties. Only predicts a landing while airborne.
+	UFUNCTION(BlueprintCallable, Category="Movement Trajectory")
+	void UpdateLandingPrediction();
+
+	/// Check whether a landing is predicted, and store the prediction in OutLandingPrediction along with the
+	/// time until it happens. Only valid if UpdateLandingPrediction has been called, or PrecalculateDistanceMatches
+	/// is true.
+	UFUNCTION(BlueprintCallable, Category="Movement Trajectory")
+	bool IsLandingPredicted(FVector &OutLandingPrediction, float& OutSecondsToLanding) const;
+
 	UFUNCTION(BlueprintPure, Category="RooiCore Trajectory Matching", meta=(ToolTip="Returns a predicted point relative to the actor where they'll come to a stop.", BlueprintThreadSafe))
 	static FVector PredictGroundedStopLocation(const FVector& CurrentVelocity, float BrakingDeceleration, float Friction);
 
 	UFUNCTION(BlueprintPure, Category="RooiCore Trajectory Matching", meta=(ToolTip="Returns a predicted point relative to the actor where they'll finish a pivot.", NotBlueprintThreadSafe))
-	static FVector PredictGroundedPivotLocation(const FVector& CurrentAcceleration, const FVector& CurrentVelocity, const FRotator& CurrentRotation, float Friction);
+	static FVector PredictGroundedPivotLocation(const FVector& CurrentAcceleration, const FVector& CurrentVelocity, float Friction);
 
 
 private:
@@ -177,6 +450,59 @@ private:
 	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Movement Trajectory", meta=(AllowPrivateAccess=true))
 	FVector PredictedPivotPoint { 0.f };
 
+	/// Whether or not we're airborne and expect to land. Only valid when UpdateLandingPrediction has been
+	/// called, or PrecalculateDistanceMatches is true.
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Movement Trajectory", meta=(AllowPrivateAccess=true))
+	bool bTrajectoryIsLanding { false };
+
+	/// A position relative to our location where we predict a landing. Only valid when UpdateLandingPrediction
+	/// has been called, or PrecalculateDistanceMatches is true.
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Movement Trajectory", meta=(AllowPrivateAccess=true))
+	FVector PredictedLandingPoint { 0.f };
+
+	/// How long until the predicted landing, in seconds.
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Movement Trajectory", meta=(AllowPrivateAccess=true))
+	float PredictedLandingSeconds { 0.f };
+
+	/// The height we were at when last grounded; used as the landing height for airborne predictions.
+	float LastGroundedHeight { 0.f };
+	bool bHasGroundedHeight { false };
+
+	/// Predicted seconds until the stop or pivot, alongside the predicted points.
+	float PredictedStopSeconds { 0.f };
+	float PredictedPivotSeconds { 0.f };
+
+public:
+
+	/// Broadcast when a stop or pivot prediction begins or ends, when we start moving, and when input starts
+	/// or stops, so that consumers can react to changes rather than polling every frame. Always broadcast on
+	/// the game thread, even if the trajectory tick runs elsewhere.
+	FRGTrajectoryEventNativeSignature OnTrajectoryEventNative;
+
+	/// Blueprint version of OnTrajectoryEventNative.
+	UPROPERTY(BlueprintAssignable, Category="Movement Trajectory")
+	FRGTrajectoryEventSignature OnTrajectoryEvent;
+
+	/// Broadcasts any trajectory events detected since the last call. Game thread only; called by the
+	/// subsystem at the end of the frame for events detected off the game thread.
+	void DispatchTrajectoryEvents();
+
+protected:
+
+	/// Compares the latest predictions against the last trajectory tick's, and queues an event for each change.
+	void DetectTrajectoryEvents();
+
+private:
+
+	/// What DetectTrajectoryEvents saw last time.
+	bool bEventWasStopping { false };
+	bool bEventWasPivoting { false };
+	bool bEventWasMoving { false };
+	bool bEventHadInput { false };
+
+	/// Events detected but not yet broadcast.
+	TArray<FRGTrajectoryEventData, TInlineAllocator<4>> PendingTrajectoryEvents;
+
 #if WITH_EDITORONLY_DATA
 	/// Should we start with trajectory debug enabled? Only valid in editor.
 	UPROPERTY(EditDefaultsOnly, Category="Movement Trajectory", meta=(AllowPrivateAccess=true))
@@ -189,6 +515,14 @@ private:
 	FVector DebugPreviousStop { 0.f };
 	bool bDebugHadPreviousPivot { false };
 	FVector DebugPreviousPivot { 0.f };
+
+	/// World time until which we keep showing the marker for a completed stop or pivot.
+	double DebugStopMarkerExpiry { 0.0 };
+	double DebugPivotMarkerExpiry { 0.0 };
+
+	/// Where we went ragdoll, and until when we keep showing the velocity we went with.
+	FVector DebugRagdollLaunchStart { 0.f };
+	double DebugRagdollLaunchMarkerExpiry { 0.0 };
 #endif
 	
 #pragma endregion 
@@ -202,6 +536,101 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category="Movement Trajectory")
 	FRGMovementSampleCollection PredictMovementFuture(const FTransform& FromOrigin, bool bIncludeHistory) const;
+
+	/// Native versions of GetMovementHistory and PredictMovementFuture, which fill an existing array (reusing
+	/// its allocation) rather than returning a new one.
+	void AppendMovementHistory(TArray<FRGMovementSample>& OutSamples, bool bOmitLatest) const;
+	void PredictMovementFutureInto(TArray<FRGMovementSample>& OutSamples, const FTransform& FromOrigin, bool bIncludeHistory) const;
+
+	/// Interpolates the movement history at the given number of seconds in the past, reaching back into the long
+	/// history if it's enabled. Clamped to the oldest sample we have; returns false if there's no history at all.
+	UFUNCTION(BlueprintCallable, Category="Movement Trajectory")
+	bool SampleMovementHistory(float SecondsAgo, FRGMovementSample& OutSample) const;
+
+	/// The long history's keyframes followed by the full-rate history, oldest first.
+	UFUNCTION(BlueprintCallable, Category="Movement Trajectory")
+	FRGMovementSampleCollection GetLongMovementHistory() const;
+
+	/// Predicts a single sample the given number of seconds in the future. This is constant-time, so it can
+	/// be used to sample the future at whatever rate a consumer needs, independent of TrajectorySimSampleRate.
+	UFUNCTION(BlueprintCallable, Category="Movement Trajectory")
+	FRGMovementSample PredictMovementAtTime(const FTransform& FromOrigin, float SecondsInFuture) const;
+
+	/// Predicts a candidate future for each of the given hypotheses in a single pass. The history estimate and
+	/// the first HypothesisReactionSeconds of movement are shared between them, and only worked out once. Uses
+	/// the movement model alone; path following and root motion aren't applied.
+	UFUNCTION(BlueprintCallable, Category="Movement Trajectory")
+	TArray<FRGMovementSampleCollection> PredictMovementHypotheses(const TArray<ERGTrajectoryHypothesis>& Hypotheses, const FTransform& FromOrigin) const;
+
+	/// Native version of PredictMovementHypotheses, filling a compact (and reusable) hypothesis set.
+	void PredictMovementHypothesesInto(TConstArrayView<ERGTrajectoryHypothesis> Hypotheses, const FTransform& FromOrigin, FRGTrajectoryHypothesisSet& OutSet) const;
+
+	/// How long, in seconds, before a hypothetical change of input takes effect.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Hypotheses", meta=(ClampMin=0))
+	float HypothesisReactionSeconds { 0.1f };
+
+	/// How far, in degrees, the turning hypotheses turn the input.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Hypotheses", meta=(ClampMin=0, ClampMax=180))
+	float HypothesisTurnAngle { 90.f };
+
+	/// Identifies a point in the movement history, so that everything recorded after it can be thrown away.
+	struct FHistoryCheckpoint
+	{
+		uint64 Sequence { 0 };
+		double Time { 0.0 };
+	};
+
+	/// Marks the current end of the movement history. Constant time.
+	FHistoryCheckpoint CheckpointHistory() const;
+
+	/// Discards everything recorded after the checkpoint, along with the motion estimate built from it. Only
+	/// touches the discarded samples.
+	void RestoreHistory(const FHistoryCheckpoint& Checkpoint);
+
+	/// Discards every sample recorded after the given GMC time. Used when GMC replays moves after a correction,
+	/// so that the replay can re-record the tail of the history.
+	void RewindHistoryTo(double Time);
+
+	/// Tells the history that the pawn jumped from one transform to another outside of normal movement (a
+	/// teleport, or a correction which isn't replayed). If carrying the history, it's moved along rigidly with the
+	/// pawn; otherwise it's marked as broken, and nothing from before the jump is reported again. Constant time
+	/// either way. Game thread only.
+	UFUNCTION(BlueprintCallable, Category="Movement Trajectory")
+	void ReanchorHistory(const FTransform& FromTransform, const FTransform& ToTransform, bool bCarryHistory);
+
+	/// Broadcast whenever the history is re-anchored, so that anything tracking positions along it (such as
+	/// distance matching) knows to start over.
+	UPROPERTY(BlueprintAssignable, Category="Movement Trajectory")
+	FRGTrajectoryDiscontinuitySignature OnTrajectoryDiscontinuity;
+
+	/// Takes over the trajectory state of a Mass agent this pawn is replacing, so that its history, motion
+	/// estimate and stop/pivot predictions carry straight on rather than starting from nothing. Replaces our
+	/// own history; no discontinuity is reported, since as far as anyone watching is concerned it's the same
+	/// agent. MassTime is the world time the agent's history is stamped against. Game thread only.
+	void ImportMassTrajectory(const FRGTrajectoryMassHistoryFragment& History, const FRGTrajectoryMassStateFragment& State, double MassTime);
+
+	/// The reverse of ImportMassTrajectory, for handing a pawn back to Mass: fills in the agent's fragments
+	/// from the newest of our history and our current predictions.
+	void ExportMassTrajectory(FRGTrajectoryMassHistoryFragment& OutHistory, FRGTrajectoryMassStateFragment& OutState, double MassTime) const;
+
+	/// If the pawn ends up further than this from where its velocity should have taken it in a single tick, we
+	/// treat it as a teleport and re-anchor the history. Zero disables detection.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory", meta=(ClampMin=0))
+	float HistoryTeleportDistance { 500.f };
+
+	/// Whether a detected teleport carries the history along with the pawn, rather than breaking it.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory")
+	bool bCarryHistoryOnTeleport { false };
+
+	/// Builds the analytic trajectory model from the latest trajectory snapshot, starting at the given origin.
+	void BuildTrajectoryModel(const FTransform& FromOrigin, FRGTrajectoryModel& OutModel) const;
+
+	/// Works out the input BuildTrajectoryModel initializes its model with, including the history estimate.
+	void BuildTrajectoryModelInput(const FTransform& FromOrigin, FRGTrajectoryModelInput& Input) const;
+
+	/// Replaces predicted samples with the snapshot's root motion for as long as its montage will still be
+	/// playing; later samples carry on from wherever the root motion leaves the pawn. Constant time per sample.
+	void SpliceRootMotion(const FRGTrajectoryModel& Model, const FTransform& FromOrigin, TArrayView<FRGMovementSample> Samples) const;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Movement Trajectory")
 	bool bTrajectoryEnabled { true };
@@ -209,11 +638,28 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Movement Trajectory|Precalculations")
 	bool bPrecalculateFutureTrajectory { true };
 	
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory")
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory", meta=(ClampMin=1))
 	int32 MaxTrajectorySamples = { 200 };
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory")
 	float TrajectoryHistorySeconds { 2.f };
+
+	/// How far back, in seconds, to keep compressed keyframes once samples age out of the full-rate history.
+	/// Zero disables the long history.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Long History", meta=(ClampMin=0))
+	float LongHistorySeconds { 0.f };
+
+	/// The most keyframes the long history will keep, whatever LongHistorySeconds says.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Long History", meta=(ClampMin=2))
+	int32 MaxLongHistoryKeyframes { 256 };
+
+	/// How far, in units, the long history may drift from the path actually taken.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Long History", meta=(ClampMin=0))
+	float LongHistoryPositionTolerance { 5.f };
+
+	/// How far, in degrees, the long history may drift from the rotation actually taken.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Long History", meta=(ClampMin=0))
+	float LongHistoryRotationTolerance { 5.f };
 	
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory")
 	int32 TrajectorySimSampleRate = { 30 };
@@ -221,10 +667,125 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory")
 	float TrajectorySimSeconds = { 1.f };
 
+	/// How quickly the predicted turn rate falls off, per second. The default matches the old stepped
+	/// prediction at 30 samples per second, which divided the turn rate by 1.1 each sample.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory", meta=(ClampMin=0))
+	float TrajectoryTurnRateDecay = { 2.859f };
+
+	/// The acceleration input is assumed to apply when the movement history doesn't show one, such as while
+	/// holding a steady course at speed. Should match the pawn's input acceleration.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory", meta=(ClampMin=0))
+	float TrajectoryMaxAcceleration = { 2048.f };
+
+	/// Time constant, in seconds, used to smooth the velocity, acceleration and turn rate estimated from
+	/// movement history. Larger values reject more noise but respond more slowly.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory", meta=(ClampMin=0))
+	float TrajectoryEstimatorSmoothingTime = { 0.05f };
+
+	/// The fraction of input acceleration applied to airborne predictions. Should match the air control
+	/// the pawn actually moves with.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory", meta=(ClampMin=0))
+	float AirborneTrajectoryControl = { 0.05f };
+
+	/// How strongly water resists movement in swimming predictions, per second. Swimming velocity relaxes
+	/// towards input acceleration divided by this value.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory", meta=(ClampMin=0))
+	float SwimmingTrajectoryDrag = { 2.f };
+
+	/// While a root motion montage is playing, predict from its baked root motion rather than the movement model.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Root Motion")
+	bool bPredictRootMotion { true };
+
+	/// Montages whose root motion is baked when play begins, so that the first time each one plays doesn't pay
+	/// for it. Any other root motion montage is baked the first time it plays.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Root Motion")
+	TArray<TObjectPtr<UAnimMontage>> PrebakedRootMotionMontages;
+
+	/// While grounded, predict along the given world-space points rather than from the movement model. Speed along
+	/// the path follows the same acceleration and braking as the movement model, coming to a stop at the end.
+	/// Takes precedence over any navigation path.
+	UFUNCTION(BlueprintCallable, Category="Movement Trajectory|Path Following")
+	void SetPredictionPath(const TArray<FVector>& Points);
+
+	/// As SetPredictionPath, with the spline converted to a polyline which stays within Tolerance units of it.
+	UFUNCTION(BlueprintCallable, Category="Movement Trajectory|Path Following")
+	void SetPredictionPathFromSpline(const USplineComponent* Spline, float Tolerance = 5.f);
+
+	UFUNCTION(BlueprintCallable, Category="Movement Trajectory|Path Following")
+	void ClearPredictionPath();
+
+	/// If we're controlled by an AI controller which is following a navigation path, predict along that path.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Path Following")
+	bool bPredictAlongNavigationPath { true };
+
+	/// The speed profile along a path is only rebuilt when the path changes, or when the pawn is further than
+	/// this from where the profile put it.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Path Following", meta=(ClampMin=0))
+	float PathProfileDistanceTolerance { 10.f };
+
+	/// As PathProfileDistanceTolerance, for the difference between the pawn's speed and the profile's.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Path Following", meta=(ClampMin=0))
+	float PathProfileSpeedTolerance { 25.f };
+
+	/// Replaces predicted samples with ones along the snapshot's path, if it has one. Constant time per sample.
+	void FollowPredictionPath(const FTransform& FromOrigin, TArrayView<FRGMovementSample> Samples) const;
+
+protected:
+
+	/// Works out which path (if any) we're following and where we are on it, rebuilding our copy of the path
+	/// and its speed profile only if they've changed. Game thread only.
+	void UpdatePredictionPath(FRGTrajectorySnapshot& Snapshot);
+
+private:
+
+	TSharedPtr<const FRGTrajectoryPath> ExplicitPredictionPath;
+
+	/// Our copy of the navigation path, and the path and timestamp it was copied from.
+	TSharedPtr<const FRGTrajectoryPath> NavigationPredictionPath;
+	TWeakPtr<FNavigationPath, ESPMode::ThreadSafe> CachedNavigationPath;
+	float CachedNavigationPathTimeStamp { 0.f };
+
+	/// The path the current speed profile was built for, and when and where along it the profile starts.
+	TSharedPtr<const FRGTrajectoryPath> ProfiledPath;
+	RGTrajectoryCore::FPathSpeedProfile PathProfile;
+	double PathProfileStartTime { 0.0 };
+	double PathProfileStartDistance { 0.0 };
+	float PathProfileMaxSpeed { 0.f };
+	int32 PathSegmentHint { 0 };
+
+public:
+
 	/// The last predicted trajectory. Only valid if PrecalculateFutureTrajectory is true, or
 	/// UpdateTrajectoryPrediction has been manually called.
 	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Movement Trajectory")
 	FRGMovementSampleCollection PredictedTrajectory;
+
+	/// Interpolates PredictedTrajectory at the given number of seconds from now (negative for history). Use this
+	/// rather than indexing the samples directly if the trajectory is adaptive. Returns false if it's empty.
+	UFUNCTION(BlueprintCallable, Category="Movement Trajectory")
+	bool SamplePredictedTrajectory(float Seconds, FRGMovementSample& OutSample) const { return PredictedTrajectory.SampleAtTime(Seconds, OutSample); }
+
+	/// If true, PredictedTrajectory and the movement history only keep the samples needed to describe them to
+	/// within the adaptive tolerances, rather than one per simulation step or frame; a straight run needs only
+	/// its ends. Samples are no longer evenly spaced, so read them with SamplePredictedTrajectory and
+	/// SampleMovementHistory.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Adaptive")
+	bool bAdaptiveTrajectory { false };
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Adaptive", meta=(ClampMin=0))
+	float AdaptivePositionTolerance { 2.f };
+
+	/// In degrees.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Adaptive", meta=(ClampMin=0))
+	float AdaptiveRotationTolerance { 2.f };
+
+	/// In units per second.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Movement Trajectory|Adaptive", meta=(ClampMin=0))
+	float AdaptiveSpeedTolerance { 10.f };
+
+	/// Bumped whenever PredictedTrajectory is rebuilt, so that anything derived from it (such as the subsystem's
+	/// spatial index) can tell when it's out of date.
+	uint32 GetPredictionRevision() const { return PredictionRevision; }
 	
 protected:
 
@@ -237,7 +798,7 @@ protected:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category="Movement Trajectory")
 	void AddNewMovementSample(const FRGMovementSample& Sample);
 
-	void CullMovementSampleHistory(bool bIsNearlyZero, const FRGMovementSample& LatestSample);
+	void CullMovementSampleHistory(bool bIsNearlyZero, const FRGMovementSample& LatestSample, double LatestTime);
 
 	UFUNCTION(BlueprintNativeEvent, Category="Movement Trajectory")
 	void UpdateMovementSamples();
@@ -247,13 +808,163 @@ protected:
 	
 private:
 
-	TRingBuffer<FRGMovementSample> MovementSamples;
+	/// Converts a history sample back to world space, filling in its relative data with respect to the given
+	/// (latest) entry.
+	FRGMovementSample ResolveHistorySample(const FRGTrajectoryHistoryEntry& Entry, const FRGTrajectoryHistoryEntry& Latest) const;
+
+	/// Converts a long history keyframe back to world space, relative to the given (latest) entry.
+	FRGMovementSample ResolveHistoryKeyframe(const FRGTrajectoryKeyframe& Keyframe, const FRGTrajectoryHistoryEntry& Latest) const;
+
+	/// Hands an entry leaving the full-rate history on to the long history.
+	void ArchiveHistoryEntry(const FRGTrajectoryHistoryEntry& Entry);
+
+	/// Converts a world space sample into HistoryAnchor space, for storage.
+	FRGMovementSample ToHistorySpace(const FRGMovementSample& Sample) const;
+
+	/// Brings the latest sample and motion estimate back in line with the end of the history, after it's been cut short.
+	void SyncToHistoryTail();
+
+	/// Normally lives in a slot in the subsystem's shared arena; if it won't fit in one, it's given a single heap
+	/// allocation at BeginPlay instead.
+	TRGTrajectoryBuffer<FRGTrajectoryHistoryEntry> MovementHistory;
+
+	/// Our slot in URGTrajectorySubsystem's history arena, if we have one.
+	int32 HistorySlot { INDEX_NONE };
+	int32 HistorySlotClass { INDEX_NONE };
+
+	/// Compressed history from beyond TrajectoryHistorySeconds, in the same space as MovementHistory.
+	FRGTrajectoryKeyframeHistory LongHistory;
+	uint64 NextHistorySequence { 1 };
+
+	/// With an adaptive trajectory, the points dropped from between the last two history entries, in the same
+	/// space as MovementHistory. Only valid while the last entry is still AdaptiveHistoryTailSequence; anything
+	/// else touching the end of the history closes the segment.
+	TArray<FRGTrajectoryKeyframe, TInlineAllocator<FRGTrajectoryKeyframeHistory::MaxWindow>> AdaptiveHistoryWindow;
+	uint64 AdaptiveHistoryTailSequence { 0 };
+
+	/// Whether the last history entry can be replaced by a new one without anything in between straying from
+	/// the adaptive tolerances.
+	bool CanReplaceHistoryTail(const FRGTrajectoryHistoryEntry& NewEntry) const;
+
+	/// The transform every history entry (and the motion estimate) is relative to. Moving it moves the whole
+	/// history at once.
+	FTransform HistoryAnchor { FTransform::Identity };
+
+	/// Entries before this sequence number are from before a break in the history, and are ignored.
+	uint64 HistoryBreakSequence { 0 };
+
+	/// Set when the history is re-anchored, until the next trajectory tick passes it on to animation.
+	bool bHistoryDiscontinuityPending { false };
+
+	uint32 PredictionRevision { 0 };
 	FRGMovementSample LastMovementSample;
-	
-	float LastTrajectoryGameSeconds { 0.f };
+
+	/// Running velocity/acceleration/turn rate estimate, updated with each new movement sample.
+	FRGMotionEstimator MotionEstimator;
+
+	/// The most recent GMC move time we've seen, and, while GMC is replaying moves, the time it'll be caught
+	/// up again at (negative when not replaying).
+	double LastMoveTime { 0.0 };
+	double ReplayUntilTime { -1.0 };
 
 	float EffectiveTrajectoryTimeDomain { 0.f };	
 	
+#pragma endregion
+
+	// Collision-aware prediction, via amortized asynchronous sweeps along the predicted path.
+#pragma region Prediction Collision
+public:
+
+	/// If true, the predicted trajectory and stop/pivot points are clipped against world collision. Sweeps
+	/// are issued asynchronously and their results applied a frame later, so this never blocks on a trace.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Movement Trajectory|Collision")
+	bool bCollisionAwarePrediction { false };
+
+	/// The channel to sweep the predicted path against.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Movement Trajectory|Collision")
+	TEnumAsByte<ECollisionChannel> PredictionCollisionChannel { ECC_Pawn };
+
+	/// The most sweeps this pawn will issue in a single frame; the predicted path is split into this many
+	/// segments. There is also a global per-frame budget, rg.Trajectory.MaxPredictionSweepsPerFrame.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Movement Trajectory|Collision", meta=(ClampMin=1))
+	int32 MaxPredictionSweepsPerFrame { 3 };
+
+	/// Whether the last completed set of sweeps found something blocking the predicted path.
+	UFUNCTION(BlueprintPure, Category="Movement Trajectory|Collision")
+	bool IsPredictionBlocked() const { return PredictionBlock.bBlocked; }
+
+	/// If the predicted path is blocked, the world-space location and time (in seconds from now, as of the
+	/// sweep) of the first blocking hit.
+	UFUNCTION(BlueprintPure, Category="Movement Trajectory|Collision")
+	bool GetPredictionBlock(FVector& OutLocation, FVector& OutNormal, float& OutSeconds) const;
+
+protected:
+
+	/// Clip the cached predicted trajectory and stop/pivot points against the last sweep results.
+	void ApplyPredictionCollision();
+
+	/// Issue a new set of sweeps along the cached predicted trajectory, if the previous set is complete.
+	void IssuePredictionSweeps();
+
+	void OnPredictionSweepComplete(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+private:
+
+	struct FPredictionBlock
+	{
+		bool bBlocked { false };
+		float Seconds { 0.f };
+		FVector Location { 0.f };
+		FVector Normal { 0.f };
+	};
+
+	struct FPredictionSweep
+	{
+		FTraceHandle Handle;
+		float StartSeconds { 0.f };
+		float EndSeconds { 0.f };
+	};
+
+	FTraceDelegate PredictionSweepDelegate;
+
+	/// Sweeps we're still waiting on, and the best block found among those that have completed.
+	TArray<FPredictionSweep, TInlineAllocator<4>> PendingPredictionSweeps;
+	FPredictionBlock PendingPredictionBlock;
+
+	/// The block found by the most recent complete set of sweeps.
+	FPredictionBlock PredictionBlock;
+
+#pragma endregion
+
+	// Animation-facing view of the trajectory, for worker thread anim graphs.
+#pragma region Animation Data
+public:
+
+	/// Native access to the trajectory data for animation, for anim instance proxies to copy from in PreUpdate.
+	/// Valid once the trajectory tick has run, which our skeletal mesh is made to wait for.
+	const FRGTrajectoryAnimData& GetTrajectoryAnimData() const { return TrajectoryAnimData; }
+
+	UFUNCTION(BlueprintPure, Category="Movement Trajectory|Animation", meta=(BlueprintThreadSafe))
+	bool GetAnimStopPrediction(FVector& OutStopPoint) const { OutStopPoint = TrajectoryAnimData.StopPoint; return TrajectoryAnimData.bIsStopping; }
+
+	UFUNCTION(BlueprintPure, Category="Movement Trajectory|Animation", meta=(BlueprintThreadSafe))
+	bool GetAnimPivotPrediction(FVector& OutPivotPoint) const { OutPivotPoint = TrajectoryAnimData.PivotPoint; return TrajectoryAnimData.bIsPivoting; }
+
+	UFUNCTION(BlueprintPure, Category="Movement Trajectory|Animation", meta=(BlueprintThreadSafe))
+	float GetAnimInputVelocityOffset() const { return TrajectoryAnimData.InputVelocityOffset; }
+
+	UFUNCTION(BlueprintPure, Category="Movement Trajectory|Animation", meta=(BlueprintThreadSafe))
+	FVector GetAnimEffectiveAcceleration() const { return TrajectoryAnimData.EffectiveAcceleration; }
+
+	/// Filled in at the end of every trajectory tick. Bind to this with property access, rather than calling a
+	/// getter, to read the samples without copying them.
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Movement Trajectory|Animation")
+	FRGTrajectoryAnimData TrajectoryAnimData;
+
+protected:
+
+	void UpdateTrajectoryAnimData();
+
 #pragma endregion
 
 	// Ragdoll experiment
@@ -271,6 +982,75 @@ public:
 	void SetRagdollActive(bool bActive);
 
 	virtual EGMC_MovementMode GetRagdollMode() const { return EGMC_MovementMode::Custom1; }
+
+	/// Performs a pending ragdoll enable or disable. Called by URGTrajectorySubsystem when our turn comes up
+	/// in its transition queue.
+	void ProcessRagdollTransition();
+
+	/// The body our ragdoll hangs from, resolved at BeginPlay. May be null if the mesh has no such body.
+	FBodyInstance* GetRagdollPelvisBody() const;
+
+	/// Everything at and below this bone is simulated when we go ragdoll.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Ragdoll")
+	FName RagdollPelvisBoneName { TEXT("pelvis") };
+
+	/// If true, the root (and thus the collision) is carried along with the ragdoll's pelvis while ragdolling,
+	/// rather than being left where the pawn fell over.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Ragdoll")
+	bool bFollowRagdollWithRoot { true };
+
+	/// The pelvis bone's local axis which points up the spine, used to work out which way to face when getting up.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Ragdoll")
+	FVector RagdollPelvisSpineAxis { 1.f, 0.f, 0.f };
+
+	/// The pelvis bone's local axis which points out of the pawn's front; if it points upwards, we're face up.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category="Ragdoll")
+	FVector RagdollPelvisFrontAxis { 0.f, -1.f, 0.f };
+
+	/// True once the physics thread has reported the ragdoll's pelvis since we went ragdoll.
+	UFUNCTION(BlueprintPure, Category="Ragdoll")
+	bool IsRagdollTracked() const { return bRagdollTracked; }
+
+	/// The ragdoll's pelvis location, as of the most recent physics step.
+	UFUNCTION(BlueprintPure, Category="Ragdoll")
+	FVector GetRagdollTrackedLocation() const { return RagdollTrackedLocation; }
+
+	/// The ragdoll's pelvis velocity, as of the most recent physics step.
+	UFUNCTION(BlueprintPure, Category="Ragdoll")
+	FVector GetRagdollTrackedVelocity() const { return RagdollTrackedVelocity; }
+
+	/// Whether the ragdoll is lying on its back.
+	UFUNCTION(BlueprintPure, Category="Ragdoll")
+	bool IsRagdollFaceUp() const { return bRagdollFaceUp; }
+
+	/// The rotation the pawn should take when it gets up from where the ragdoll is lying.
+	UFUNCTION(BlueprintPure, Category="Ragdoll")
+	FRotator GetRagdollGetUpRotation() const { return RagdollGetUpRotation; }
+
+protected:
+
+	/// Resolves the ragdoll body indices and makes sure the mesh's physics bodies exist ahead of time.
+	void CacheRagdollBodies();
+
+	void ApplyRagdollEnable();
+
+	/// Stands the pawn back up and stops the ragdoll's bodies simulating; the mesh is put back on a later turn,
+	/// by FinishRagdollDisable.
+	void ApplyRagdollDisable();
+	void FinishRagdollDisable();
+
+	/// Looks for the floor beneath the ragdoll's pelvis, for ApplyRagdollDisable to stand the pawn on. Async; the
+	/// disable waits for the result.
+	void IssueRagdollFloorTrace();
+	void CancelRagdollFloorTrace();
+	void OnRagdollFloorTraceComplete(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	/// Registers a physics thread callback which reports the pelvis's state back to us every physics step.
+	void StartRagdollTracking();
+	void StopRagdollTracking();
+
+	/// Feeds the physics thread callback, consumes whatever it has reported, and moves the root to follow.
+	void UpdateRagdollTracking();
 	
 private:
 	
@@ -282,12 +1062,43 @@ private:
 
 	bool bFirstRagdollTick { false };
 
+	/// True between ApplyRagdollEnable and ApplyRagdollDisable, i.e. while there's a ragdoll to undo.
+	bool bRagdollApplied { false };
+
+	/// True between ApplyRagdollDisable and FinishRagdollDisable, while the mesh waits to be reattached.
+	bool bRagdollReattachPending { false };
+
+	FTraceDelegate RagdollFloorTraceDelegate;
+	FTraceHandle RagdollFloorTraceHandle;
+	bool bRagdollFloorTracePending { false };
+
+	/// Where the floor trace hit, if it did.
+	bool bRagdollFloorFound { false };
+	FVector RagdollFloorLocation { 0.f };
+
 	FVector PreviousRelativeMeshLocation { 0.f };
 	FRotator PreviousRelativeMeshRotation { 0.f };
 	float PreviousCollisionHalfHeight { 0.f };
 	
 	FVector RagdollLinearVelocity { 0.f };
 	int32 BI_RagdollLinearVelocity { -1 };
+
+	/// True while we're waiting in the subsystem's transition queue.
+	bool bRagdollTransitionQueued { false };
+
+	/// Physics asset body indices, resolved at BeginPlay.
+	int32 RagdollPelvisBodyIndex { INDEX_NONE };
+	TArray<int32> RagdollBodyIndices;
+
+	/// Owned by the physics solver; only valid between StartRagdollTracking and StopRagdollTracking.
+	FRGRagdollTrackingCallback* RagdollTrackingCallback { nullptr };
+
+	bool bRagdollTracked { false };
+	FVector RagdollTrackedLocation { 0.f };
+	FVector RagdollTrackedVelocity { 0.f };
+	FQuat RagdollTrackedRotation { FQuat::Identity };
+	bool bRagdollFaceUp { false };
+	FRotator RagdollGetUpRotation { 0.f };
 	
 #pragma endregion
 	
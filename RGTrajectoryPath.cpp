@@ -0,0 +1,87 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+#include "RGTrajectoryPath.h"
+
+void FRGTrajectoryPath::SetPoints(TConstArrayView<FVector> InPoints)
+{
+	Reset();
+	Points.Reserve(InPoints.Num());
+	Distances.Reserve(InPoints.Num());
+
+	for (const FVector& Point : InPoints)
+	{
+		if (!Points.IsEmpty() && Point.Equals(Points.Last(), UE_KINDA_SMALL_NUMBER)) continue;
+
+		Distances.Add(Points.IsEmpty() ? 0.0 : Distances.Last() + FVector::Dist(Points.Last(), Point));
+		Points.Add(Point);
+	}
+}
+
+void FRGTrajectoryPath::Reset()
+{
+	Points.Reset();
+	Distances.Reset();
+}
+
+double FRGTrajectoryPath::Project(const FVector& Location, int32& InOutSegment, int32 MaxSegments) const
+{
+	if (!IsValid()) return 0.0;
+
+	const int32 FirstSegment = FMath::Clamp(InOutSegment, 0, NumSegments() - 1);
+	const int32 LastSegment = FMath::Min(FirstSegment + MaxSegments, NumSegments()) - 1;
+
+	double BestDistance = 0.0;
+	double BestDistSquared = TNumericLimits<double>::Max();
+	for (int32 Segment = FirstSegment; Segment <= LastSegment; Segment++)
+	{
+		const FVector Closest = FMath::ClosestPointOnSegment(Location, Points[Segment], Points[Segment + 1]);
+		const double DistSquared = FVector::DistSquared(Location, Closest);
+		if (DistSquared < BestDistSquared)
+		{
+			BestDistSquared = DistSquared;
+			BestDistance = Distances[Segment] + FVector::Dist(Points[Segment], Closest);
+			InOutSegment = Segment;
+		}
+	}
+
+	return BestDistance;
+}
+
+FVector FRGTrajectoryPath::Evaluate(double Distance, FVector& OutDirection, int32& InOutSegment) const
+{
+	if (!IsValid())
+	{
+		OutDirection = FVector::ZeroVector;
+		return Points.IsEmpty() ? FVector::ZeroVector : Points[0];
+	}
+
+	const double ClampedDistance = FMath::Clamp(Distance, 0.0, GetLength());
+
+	int32 Segment = FMath::Clamp(InOutSegment, 0, NumSegments() - 1);
+	while (Segment > 0 && ClampedDistance < Distances[Segment])
+	{
+		Segment--;
+	}
+	while (Segment < NumSegments() - 1 && ClampedDistance > Distances[Segment + 1])
+	{
+		Segment++;
+	}
+	InOutSegment = Segment;
+
+	const double SegmentLength = Distances[Segment + 1] - Distances[Segment];
+	const double Alpha = SegmentLength > UE_SMALL_NUMBER ? (ClampedDistance - Distances[Segment]) / SegmentLength : 0.0;
+
+	OutDirection = (Points[Segment + 1] - Points[Segment]).GetSafeNormal();
+	return FMath::Lerp(Points[Segment], Points[Segment + 1], Alpha);
+}
@@ -0,0 +1,51 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/// A polyline for a pawn to be predicted along, such as an AI navigation path, with the distance along it to each
+/// point worked out up front. Lookups take a segment hint, so that walking forward along the path (as successive
+/// prediction samples do) costs constant time per lookup.
+class ROOICORE_API FRGTrajectoryPath
+{
+public:
+
+	/// Replaces the path with the given world-space points. Consecutive duplicate points are dropped.
+	void SetPoints(TConstArrayView<FVector> InPoints);
+
+	void Reset();
+
+	/// A path needs at least two distinct points to be followed.
+	bool IsValid() const { return Points.Num() >= 2; }
+
+	double GetLength() const { return Distances.IsEmpty() ? 0.0 : Distances.Last(); }
+	int32 NumSegments() const { return FMath::Max(Points.Num() - 1, 0); }
+	TConstArrayView<FVector> GetPoints() const { return Points; }
+
+	/// The distance along the path of the closest point to Location, looking at most MaxSegments segments on from
+	/// InOutSegment; InOutSegment is updated to the segment the closest point lies on.
+	double Project(const FVector& Location, int32& InOutSegment, int32 MaxSegments = 4) const;
+
+	/// The point at the given distance along the path, clamped to the path, and the direction of travel there.
+	/// InOutSegment is a hint which is updated to the segment the point lies on.
+	FVector Evaluate(double Distance, FVector& OutDirection, int32& InOutSegment) const;
+
+private:
+
+	TArray<FVector> Points;
+
+	/// Distance along the path to each point.
+	TArray<double> Distances;
+};
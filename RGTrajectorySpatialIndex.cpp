@@ -0,0 +1,319 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+#include "RGTrajectorySpatialIndex.h"
+#include "Algo/SortBy.h"
+
+FVector FRGTrajectorySegment::GetLocationAtTime(double Time) const
+{
+	const double Span = EndTime - StartTime;
+	const float Alpha = Span > UE_SMALL_NUMBER ? FMath::Clamp(static_cast<float>((Time - StartTime) / Span), 0.f, 1.f) : 0.f;
+	return FMath::Lerp(Start, End, Alpha);
+}
+
+namespace
+{
+	/// Trims a segment to the part of it inside a time window. Returns false if none of it is.
+	bool ClipSegmentToWindow(const FRGTrajectorySegment& Segment, double FromTime, double ToTime, FRGTrajectorySegment& OutClipped)
+	{
+		const double StartTime = FMath::Max(Segment.StartTime, FromTime);
+		const double EndTime = FMath::Min(Segment.EndTime, ToTime);
+		if (StartTime > EndTime) return false;
+
+		OutClipped = Segment;
+		OutClipped.Start = Segment.GetLocationAtTime(StartTime);
+		OutClipped.End = Segment.GetLocationAtTime(EndTime);
+		OutClipped.StartTime = StartTime;
+		OutClipped.EndTime = EndTime;
+		return true;
+	}
+
+	/// The time at which a clipped segment passes through a point on it.
+	double GetTimeAtLocation(const FRGTrajectorySegment& Segment, const FVector& Location)
+	{
+		const double Length = FVector::Dist(Segment.Start, Segment.End);
+		const double Alpha = Length > UE_SMALL_NUMBER ? FVector::Dist(Segment.Start, Location) / Length : 0.0;
+		return FMath::Lerp(Segment.StartTime, Segment.EndTime, Alpha);
+	}
+}
+
+void FRGTrajectorySpatialIndex::SetCellSize(float InCellSize)
+{
+	Reset();
+	CellSize = FMath::Max(InCellSize, 1.f);
+}
+
+void FRGTrajectorySpatialIndex::SetOwnerSegments(int32 Owner, TConstArrayView<FRGTrajectorySegment> NewSegments)
+{
+	RemoveOwner(Owner);
+	if (NewSegments.IsEmpty()) return;
+
+	TArray<int32>& Owned = OwnerSegments.Add(Owner);
+	Owned.Reserve(NewSegments.Num());
+
+	for (const FRGTrajectorySegment& Segment : NewSegments)
+	{
+		int32 Index;
+		if (FreeSegments.IsEmpty())
+		{
+			Index = Segments.Add(Segment);
+			SegmentStamps.Add(0);
+		}
+		else
+		{
+			Index = FreeSegments.Pop(false);
+			Segments[Index] = Segment;
+		}
+		Segments[Index].Owner = Owner;
+		Owned.Add(Index);
+
+		FIntPoint Min, Max;
+		GetCellRange(Segment.Start, Segment.End, 0.f, Min, Max);
+		for (int32 X = Min.X; X <= Max.X; X++)
+		{
+			for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+			{
+				Cells.FindOrAdd(FIntPoint(X, Y)).Add(Index);
+			}
+		}
+	}
+}
+
+void FRGTrajectorySpatialIndex::RemoveOwner(int32 Owner)
+{
+	TArray<int32> Owned;
+	if (!OwnerSegments.RemoveAndCopyValue(Owner, Owned)) return;
+
+	for (const int32 Index : Owned)
+	{
+		const FRGTrajectorySegment& Segment = Segments[Index];
+
+		FIntPoint Min, Max;
+		GetCellRange(Segment.Start, Segment.End, 0.f, Min, Max);
+		for (int32 X = Min.X; X <= Max.X; X++)
+		{
+			for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+			{
+				const FIntPoint Key(X, Y);
+				if (TArray<int32>* Cell = Cells.Find(Key))
+				{
+					Cell->RemoveSingleSwap(Index, false);
+					if (Cell->IsEmpty())
+					{
+						Cells.Remove(Key);
+					}
+				}
+			}
+		}
+
+		FreeSegments.Add(Index);
+	}
+}
+
+void FRGTrajectorySpatialIndex::Reset()
+{
+	Segments.Reset();
+	FreeSegments.Reset();
+	Cells.Reset();
+	OwnerSegments.Reset();
+	SegmentStamps.Reset();
+}
+
+FIntPoint FRGTrajectorySpatialIndex::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+void FRGTrajectorySpatialIndex::GetCellRange(const FVector& A, const FVector& B, float Radius, FIntPoint& OutMin, FIntPoint& OutMax) const
+{
+	const FVector Min = A.ComponentMin(B) - FVector(Radius);
+	const FVector Max = A.ComponentMax(B) + FVector(Radius);
+	OutMin = GetCell(Min);
+	OutMax = GetCell(Max);
+}
+
+void FRGTrajectorySpatialIndex::BeginQuery() const
+{
+	if (++QueryStamp == 0)
+	{
+		// Wrapped around; start the stamps over so that nothing looks visited.
+		FMemory::Memzero(SegmentStamps.GetData(), SegmentStamps.Num() * sizeof(uint32));
+		QueryStamp = 1;
+	}
+}
+
+template <typename VisitorType>
+void FRGTrajectorySpatialIndex::VisitCells(const FIntPoint& Min, const FIntPoint& Max, VisitorType&& Visitor) const
+{
+	for (int32 X = Min.X; X <= Max.X; X++)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+		{
+			const TArray<int32>* Cell = Cells.Find(FIntPoint(X, Y));
+			if (Cell == nullptr) continue;
+
+			for (const int32 Index : *Cell)
+			{
+				if (SegmentStamps[Index] == QueryStamp) continue;
+				SegmentStamps[Index] = QueryStamp;
+				Visitor(Segments[Index]);
+			}
+		}
+	}
+}
+
+void FRGTrajectorySpatialIndex::AddHit(TArray<FRGTrajectoryIndexHit>& OutHits, const FRGTrajectoryIndexHit& Hit)
+{
+	for (FRGTrajectoryIndexHit& Existing : OutHits)
+	{
+		if (Existing.Owner != Hit.Owner) continue;
+
+		if (Hit.Distance < Existing.Distance)
+		{
+			Existing = Hit;
+		}
+		return;
+	}
+
+	OutHits.Add(Hit);
+}
+
+void FRGTrajectorySpatialIndex::QueryPoint(const FVector& Point, float Radius, double FromTime, double ToTime,
+	TArray<FRGTrajectoryIndexHit>& OutHits) const
+{
+	BeginQuery();
+
+	FIntPoint Min, Max;
+	GetCellRange(Point, Point, Radius, Min, Max);
+	VisitCells(Min, Max, [&](const FRGTrajectorySegment& Segment)
+	{
+		FRGTrajectorySegment Clipped;
+		if (!ClipSegmentToWindow(Segment, FromTime, ToTime, Clipped)) return;
+
+		const FVector Closest = FMath::ClosestPointOnSegment(Point, Clipped.Start, Clipped.End);
+		const float Distance = FVector::Dist(Point, Closest);
+		if (Distance > Radius) return;
+
+		FRGTrajectoryIndexHit Hit;
+		Hit.Owner = Segment.Owner;
+		Hit.Time = GetTimeAtLocation(Clipped, Closest);
+		Hit.Location = Closest;
+		Hit.Distance = Distance;
+		AddHit(OutHits, Hit);
+	});
+}
+
+void FRGTrajectorySpatialIndex::QueryOwner(int32 Owner, float Radius, double FromTime, double ToTime,
+	TArray<FRGTrajectoryIndexHit>& OutHits) const
+{
+	const TArray<int32>* Owned = OwnerSegments.Find(Owner);
+	if (Owned == nullptr) return;
+
+	for (const int32 OwnedIndex : *Owned)
+	{
+		FRGTrajectorySegment Query;
+		if (!ClipSegmentToWindow(Segments[OwnedIndex], FromTime, ToTime, Query)) continue;
+
+		BeginQuery();
+
+		FIntPoint Min, Max;
+		GetCellRange(Query.Start, Query.End, Radius, Min, Max);
+		VisitCells(Min, Max, [&](const FRGTrajectorySegment& Segment)
+		{
+			if (Segment.Owner == Owner) return;
+
+			// Both trajectories only need comparing over the time they share.
+			FRGTrajectorySegment Other;
+			if (!ClipSegmentToWindow(Segment, Query.StartTime, Query.EndTime, Other)) return;
+
+			const FVector OursStart = Query.GetLocationAtTime(Other.StartTime);
+			const FVector OursEnd = Query.GetLocationAtTime(Other.EndTime);
+
+			// Both move linearly over the shared span, so their separation does too.
+			const FVector SeparationStart = Other.Start - OursStart;
+			const FVector SeparationChange = (Other.End - OursEnd) - SeparationStart;
+			const double ChangeSquared = SeparationChange.SizeSquared();
+			const double Alpha = ChangeSquared > UE_SMALL_NUMBER ? FMath::Clamp(-(SeparationStart | SeparationChange) / ChangeSquared, 0.0, 1.0) : 0.0;
+
+			const float Distance = (SeparationStart + SeparationChange * Alpha).Size();
+			if (Distance > Radius) return;
+
+			FRGTrajectoryIndexHit Hit;
+			Hit.Owner = Segment.Owner;
+			Hit.Time = FMath::Lerp(Other.StartTime, Other.EndTime, Alpha);
+			Hit.Location = FMath::Lerp(Other.Start, Other.End, Alpha);
+			Hit.Distance = Distance;
+			AddHit(OutHits, Hit);
+		});
+	}
+}
+
+void FRGTrajectorySpatialIndex::QueryRay(const FVector& Start, const FVector& End, float Radius, double FromTime, double ToTime,
+	TArray<FRGTrajectoryIndexHit>& OutHits) const
+{
+	BeginQuery();
+
+	const int32 FirstHit = OutHits.Num();
+	const int32 Reach = FMath::CeilToInt32(Radius / CellSize);
+	auto VisitSegment = [&](const FRGTrajectorySegment& Segment)
+	{
+		FRGTrajectorySegment Clipped;
+		if (!ClipSegmentToWindow(Segment, FromTime, ToTime, Clipped)) return;
+
+		FVector OnRay, OnSegment;
+		FMath::SegmentDistToSegmentSafe(Start, End, Clipped.Start, Clipped.End, OnRay, OnSegment);
+		const float Distance = FVector::Dist(OnRay, OnSegment);
+		if (Distance > Radius) return;
+
+		FRGTrajectoryIndexHit Hit;
+		Hit.Owner = Segment.Owner;
+		Hit.Time = GetTimeAtLocation(Clipped, OnSegment);
+		Hit.Location = OnSegment;
+		Hit.Distance = Distance;
+		Hit.RayDistance = FVector::Dist(Start, OnRay);
+		AddHit(OutHits, Hit);
+	};
+
+	// Walk the cells the ray crosses, looking at enough of their neighbours to cover the radius.
+	const FVector2D RayStart(Start);
+	const FVector2D RayDelta = FVector2D(End) - RayStart;
+	FIntPoint Cell = GetCell(Start);
+	const FIntPoint EndCell = GetCell(End);
+
+	const int32 StepX = RayDelta.X > 0.f ? 1 : -1;
+	const int32 StepY = RayDelta.Y > 0.f ? 1 : -1;
+	const double DeltaX = FMath::IsNearlyZero(RayDelta.X) ? UE_BIG_NUMBER : CellSize / FMath::Abs(RayDelta.X);
+	const double DeltaY = FMath::IsNearlyZero(RayDelta.Y) ? UE_BIG_NUMBER : CellSize / FMath::Abs(RayDelta.Y);
+	double NextX = FMath::IsNearlyZero(RayDelta.X) ? UE_BIG_NUMBER : ((Cell.X + (StepX > 0 ? 1 : 0)) * CellSize - RayStart.X) / RayDelta.X;
+	double NextY = FMath::IsNearlyZero(RayDelta.Y) ? UE_BIG_NUMBER : ((Cell.Y + (StepY > 0 ? 1 : 0)) * CellSize - RayStart.Y) / RayDelta.Y;
+
+	const int32 MaxSteps = FMath::Abs(EndCell.X - Cell.X) + FMath::Abs(EndCell.Y - Cell.Y);
+	for (int32 Step = 0; Step <= MaxSteps; Step++)
+	{
+		VisitCells(Cell - FIntPoint(Reach, Reach), Cell + FIntPoint(Reach, Reach), VisitSegment);
+		if (Cell == EndCell) break;
+
+		if (NextX < NextY)
+		{
+			Cell.X += StepX;
+			NextX += DeltaX;
+		}
+		else
+		{
+			Cell.Y += StepY;
+			NextY += DeltaY;
+		}
+	}
+
+	Algo::SortBy(MakeArrayView(OutHits.GetData() + FirstHit, OutHits.Num() - FirstHit), &FRGTrajectoryIndexHit::RayDistance);
+}
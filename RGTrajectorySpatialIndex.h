@@ -0,0 +1,102 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/// One leg of a predicted trajectory, between two consecutive samples, in world space and world time.
+struct ROOICORE_API FRGTrajectorySegment
+{
+	FVector Start { 0.f };
+	FVector End { 0.f };
+	double StartTime { 0.0 };
+	double EndTime { 0.0 };
+	int32 Owner { INDEX_NONE };
+
+	/// Where along the segment we are at the given time, clamped to its ends.
+	FVector GetLocationAtTime(double Time) const;
+};
+
+/// The closest a trajectory comes to whatever was queried for.
+struct ROOICORE_API FRGTrajectoryIndexHit
+{
+	int32 Owner { INDEX_NONE };
+
+	/// World time at which the trajectory is closest.
+	double Time { 0.0 };
+
+	/// Where the trajectory is at that time.
+	FVector Location { 0.f };
+
+	float Distance { 0.f };
+
+	/// For ray queries, how far along the ray the closest approach is; otherwise zero.
+	float RayDistance { 0.f };
+};
+
+/// A uniform grid over predicted trajectory segments, on the XY plane. Each owner's segments are replaced
+/// wholesale when its trajectory changes, touching only the cells they cover, so the index is maintained
+/// incrementally rather than rebuilt; queries only look at the cells near what's being queried.
+///
+/// Queries report at most one hit per owner: its closest approach within the given world time window.
+class ROOICORE_API FRGTrajectorySpatialIndex
+{
+public:
+
+	/// Sets the size of a grid cell, clearing the index. Cells should be a bit larger than the distance a
+	/// pawn covers between two trajectory samples.
+	void SetCellSize(float InCellSize);
+	float GetCellSize() const { return CellSize; }
+
+	/// Replaces all of an owner's segments.
+	void SetOwnerSegments(int32 Owner, TConstArrayView<FRGTrajectorySegment> NewSegments);
+	void RemoveOwner(int32 Owner);
+	void Reset();
+
+	int32 NumSegments() const { return Segments.Num() - FreeSegments.Num(); }
+
+	/// Finds trajectories which pass within Radius of a point.
+	void QueryPoint(const FVector& Point, float Radius, double FromTime, double ToTime, TArray<FRGTrajectoryIndexHit>& OutHits) const;
+
+	/// Finds trajectories which come within Radius of the given owner's trajectory at the same moment.
+	void QueryOwner(int32 Owner, float Radius, double FromTime, double ToTime, TArray<FRGTrajectoryIndexHit>& OutHits) const;
+
+	/// Finds trajectories which pass within Radius of a line segment, sorted by distance along it.
+	void QueryRay(const FVector& Start, const FVector& End, float Radius, double FromTime, double ToTime, TArray<FRGTrajectoryIndexHit>& OutHits) const;
+
+private:
+
+	FIntPoint GetCell(const FVector& Location) const;
+	void GetCellRange(const FVector& A, const FVector& B, float Radius, FIntPoint& OutMin, FIntPoint& OutMax) const;
+
+	/// Calls Visitor for every segment in the given cells which hasn't already been visited by this query.
+	template <typename VisitorType>
+	void VisitCells(const FIntPoint& Min, const FIntPoint& Max, VisitorType&& Visitor) const;
+
+	/// Starts a new query, so that segments can be visited at most once each.
+	void BeginQuery() const;
+
+	static void AddHit(TArray<FRGTrajectoryIndexHit>& OutHits, const FRGTrajectoryIndexHit& Hit);
+
+	float CellSize { 500.f };
+
+	TArray<FRGTrajectorySegment> Segments;
+	TArray<int32> FreeSegments;
+	TMap<FIntPoint, TArray<int32>> Cells;
+	TMap<int32, TArray<int32>> OwnerSegments;
+
+	/// The query stamp each segment was last visited with.
+	mutable TArray<uint32> SegmentStamps;
+	mutable uint32 QueryStamp { 0 };
+};
@@ -0,0 +1,374 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+#include "RGTrajectorySubsystem.h"
+#include "RGTrajectoryMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+
+DEFINE_LOG_CATEGORY(LogRGTrajectory);
+
+static TAutoConsoleVariable<int32> CVarRagdollMaxTransitionsPerFrame(
+	TEXT("rg.Ragdoll.MaxTransitionsPerFrame"),
+	4,
+	TEXT("Maximum number of ragdoll enable/disable transitions to perform per frame; zero for no limit."));
+
+static TAutoConsoleVariable<float> CVarTrajectoryIndexCellSize(
+	TEXT("rg.Trajectory.Index.CellSize"),
+	500.f,
+	TEXT("Size of a cell in the predicted trajectory spatial index. Changing it rebuilds the index."));
+
+static TAutoConsoleVariable<float> CVarTrajectoryRootMotionSampleRate(
+	TEXT("rg.Trajectory.RootMotion.SampleRate"),
+	30.f,
+	TEXT("Samples per second when baking montage root motion for trajectory prediction. Only affects montages baked after it changes."));
+
+static TAutoConsoleVariable<int32> CVarTrajectoryDebugMaxPawns(
+	TEXT("rg.Trajectory.Debug.MaxPawns"),
+	0,
+	TEXT("If greater than zero, only draw trajectory debug for this many pawns, nearest to the local viewpoint first."));
+
+static TAutoConsoleVariable<bool> CVarTrajectoryDebugLocalPlayerOnly(
+	TEXT("rg.Trajectory.Debug.LocalPlayerOnly"),
+	false,
+	TEXT("If true, only draw trajectory debug for pawns controlled by a local player."));
+
+static TAutoConsoleVariable<int32> CVarTrajectoryDebugSampleStride(
+	TEXT("rg.Trajectory.Debug.SampleStride"),
+	1,
+	TEXT("Only draw every Nth trajectory sample."));
+
+void URGTrajectorySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ProcessRagdollTransitions();
+
+	// Anything detected on a worker thread by a trajectory tick is waiting for us. Tickable objects run after
+	// every tick group has finished, so those have all completed by now.
+	for (URGTrajectoryMovementComponent* Component : TrajectoryComponents)
+	{
+		if (IsValid(Component))
+		{
+			Component->DispatchTrajectoryEvents();
+		}
+	}
+
+	UpdateTrajectoryIndex();
+	DrawTrajectoryDebug();
+}
+
+TStatId URGTrajectorySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(URGTrajectorySubsystem, STATGROUP_Tickables);
+}
+
+void URGTrajectorySubsystem::RegisterTrajectoryComponent(URGTrajectoryMovementComponent* Component)
+{
+	TrajectoryComponents.AddUnique(Component);
+
+	if (!IndexedTrajectories.Contains(Component))
+	{
+		FIndexedTrajectory& Indexed = IndexedTrajectories.Add(Component);
+		if (FreeIndexOwners.IsEmpty())
+		{
+			Indexed.Owner = IndexOwners.Add(Component);
+		}
+		else
+		{
+			Indexed.Owner = FreeIndexOwners.Pop(false);
+			IndexOwners[Indexed.Owner] = Component;
+		}
+
+		// Make sure the first update indexes whatever it's already predicted.
+		Indexed.Revision = Component->GetPredictionRevision() - 1;
+	}
+}
+
+void URGTrajectorySubsystem::UnregisterTrajectoryComponent(URGTrajectoryMovementComponent* Component)
+{
+	TrajectoryComponents.RemoveSingleSwap(Component);
+
+	FIndexedTrajectory Indexed;
+	if (IndexedTrajectories.RemoveAndCopyValue(Component, Indexed))
+	{
+		TrajectoryIndex.RemoveOwner(Indexed.Owner);
+		IndexOwners[Indexed.Owner] = nullptr;
+		FreeIndexOwners.Add(Indexed.Owner);
+	}
+}
+
+void URGTrajectorySubsystem::QueueRagdollTransition(URGTrajectoryMovementComponent* Component)
+{
+	PendingRagdollTransitions.AddUnique(Component);
+}
+
+void URGTrajectorySubsystem::DequeueRagdollTransition(URGTrajectoryMovementComponent* Component)
+{
+	PendingRagdollTransitions.Remove(Component);
+}
+
+int32 URGTrajectorySubsystem::GetHistorySlotClass(int32 Capacity)
+{
+	for (int32 SlotClass = 0; SlotClass < NumHistorySlotClasses; SlotClass++)
+	{
+		if (Capacity <= GetHistorySlotCapacity(SlotClass)) return SlotClass;
+	}
+
+	return INDEX_NONE;
+}
+
+int32 URGTrajectorySubsystem::AcquireHistorySlot(int32 SlotClass)
+{
+	check(SlotClass >= 0 && SlotClass < NumHistorySlotClasses);
+	FHistorySlotPool& Pool = HistorySlotPools[SlotClass];
+
+	if (Pool.FreeSlots.IsEmpty())
+	{
+		const int32 FirstNewSlot = Pool.Pages.Num() * HistorySlotsPerPage;
+		Pool.Pages.Add(MakeUnique<FRGTrajectoryHistoryEntry[]>(HistorySlotsPerPage * GetHistorySlotCapacity(SlotClass)));
+
+		for (int32 Slot = FirstNewSlot; Slot < FirstNewSlot + HistorySlotsPerPage; Slot++)
+		{
+			Pool.FreeSlots.HeapPush(Slot);
+		}
+	}
+
+	int32 Slot;
+	Pool.FreeSlots.HeapPop(Slot);
+	return Slot;
+}
+
+void URGTrajectorySubsystem::ReleaseHistorySlot(int32 SlotClass, int32 Slot)
+{
+	check(SlotClass >= 0 && SlotClass < NumHistorySlotClasses);
+	FHistorySlotPool& Pool = HistorySlotPools[SlotClass];
+
+	check(Slot >= 0 && Slot < Pool.Pages.Num() * HistorySlotsPerPage);
+	Pool.FreeSlots.HeapPush(Slot);
+}
+
+FRGTrajectoryHistoryEntry* URGTrajectorySubsystem::GetHistorySlotData(int32 SlotClass, int32 Slot) const
+{
+	check(SlotClass >= 0 && SlotClass < NumHistorySlotClasses);
+	const FHistorySlotPool& Pool = HistorySlotPools[SlotClass];
+
+	check(Slot >= 0 && Slot < Pool.Pages.Num() * HistorySlotsPerPage);
+	return Pool.Pages[Slot / HistorySlotsPerPage].Get() + (Slot % HistorySlotsPerPage) * GetHistorySlotCapacity(SlotClass);
+}
+
+TSharedPtr<const FRGRootMotionTable> URGTrajectorySubsystem::FindOrBakeRootMotionTable(const UAnimMontage* Montage)
+{
+	if (Montage == nullptr) return nullptr;
+
+	if (const TSharedPtr<const FRGRootMotionTable>* Existing = RootMotionTables.Find(Montage))
+	{
+		return *Existing;
+	}
+
+	TSharedPtr<FRGRootMotionTable> Table = MakeShared<FRGRootMotionTable>();
+	Table->Bake(Montage, CVarTrajectoryRootMotionSampleRate.GetValueOnGameThread());
+	if (Table->IsEmpty())
+	{
+		Table.Reset();
+	}
+
+	RootMotionTables.Add(Montage, Table);
+	return Table;
+}
+
+void URGTrajectorySubsystem::ProcessRagdollTransitions()
+{
+	if (PendingRagdollTransitions.IsEmpty()) return;
+
+	const int32 MaxTransitions = CVarRagdollMaxTransitionsPerFrame.GetValueOnGameThread();
+	const int32 Count = MaxTransitions > 0 ? FMath::Min(MaxTransitions, PendingRagdollTransitions.Num()) : PendingRagdollTransitions.Num();
+
+	// Pull the batch off first, in case processing a transition queues another.
+	TArray<TWeakObjectPtr<URGTrajectoryMovementComponent>, TInlineAllocator<16>> Batch(PendingRagdollTransitions.GetData(), Count);
+	PendingRagdollTransitions.RemoveAt(0, Count, false);
+
+	for (const TWeakObjectPtr<URGTrajectoryMovementComponent>& Component : Batch)
+	{
+		if (Component.IsValid())
+		{
+			Component->ProcessRagdollTransition();
+		}
+	}
+}
+
+void URGTrajectorySubsystem::UpdateTrajectoryIndex()
+{
+	const UWorld* World = GetWorld();
+	if (!IsValid(World)) return;
+
+	IndexTime = World->GetTimeSeconds();
+
+	const float CellSize = CVarTrajectoryIndexCellSize.GetValueOnGameThread();
+	const bool bRebuild = !FMath::IsNearlyEqual(CellSize, TrajectoryIndex.GetCellSize());
+	if (bRebuild)
+	{
+		TrajectoryIndex.SetCellSize(CellSize);
+	}
+
+	for (TPair<const URGTrajectoryMovementComponent*, FIndexedTrajectory>& Pair : IndexedTrajectories)
+	{
+		const URGTrajectoryMovementComponent* Component = Pair.Key;
+		FIndexedTrajectory& Indexed = Pair.Value;
+		if (!IsValid(Component) || (!bRebuild && Component->GetPredictionRevision() == Indexed.Revision)) continue;
+
+		Indexed.Revision = Component->GetPredictionRevision();
+
+		// Only the predicted part of the trajectory is indexed; samples are seconds from when it was predicted,
+		// which is this frame.
+		IndexSegmentScratch.Reset();
+		const TArray<FRGMovementSample>& Samples = Component->PredictedTrajectory.Samples;
+		for (int32 Idx = 1; Idx < Samples.Num(); Idx++)
+		{
+			const FRGMovementSample& From = Samples[Idx - 1];
+			const FRGMovementSample& To = Samples[Idx];
+			if (From.AccumulatedSeconds < 0.f) continue;
+
+			FRGTrajectorySegment& Segment = IndexSegmentScratch.AddDefaulted_GetRef();
+			Segment.Start = From.WorldTransform.GetLocation();
+			Segment.End = To.WorldTransform.GetLocation();
+			Segment.StartTime = IndexTime + From.AccumulatedSeconds;
+			Segment.EndTime = IndexTime + To.AccumulatedSeconds;
+		}
+
+		TrajectoryIndex.SetOwnerSegments(Indexed.Owner, IndexSegmentScratch);
+	}
+}
+
+void URGTrajectorySubsystem::ConvertIndexHits(const TArray<FRGTrajectoryIndexHit>& IndexHits, TArray<FRGTrajectoryQueryHit>& OutHits) const
+{
+	OutHits.Reserve(OutHits.Num() + IndexHits.Num());
+	for (const FRGTrajectoryIndexHit& IndexHit : IndexHits)
+	{
+		FRGTrajectoryQueryHit& Hit = OutHits.AddDefaulted_GetRef();
+		Hit.Component = IndexOwners[IndexHit.Owner];
+		Hit.Seconds = IndexHit.Time - IndexTime;
+		Hit.Location = IndexHit.Location;
+		Hit.Distance = IndexHit.Distance;
+		Hit.RayDistance = IndexHit.RayDistance;
+	}
+}
+
+void URGTrajectorySubsystem::QueryTrajectoriesNearPoint(const FVector& Point, float Radius, float WithinSeconds,
+	TArray<FRGTrajectoryQueryHit>& OutHits) const
+{
+	TArray<FRGTrajectoryIndexHit> IndexHits;
+	TrajectoryIndex.QueryPoint(Point, Radius, IndexTime, IndexTime + WithinSeconds, IndexHits);
+	ConvertIndexHits(IndexHits, OutHits);
+}
+
+void URGTrajectorySubsystem::QueryTrajectoriesNearComponent(const URGTrajectoryMovementComponent* Component, float Radius,
+	float WithinSeconds, TArray<FRGTrajectoryQueryHit>& OutHits) const
+{
+	const FIndexedTrajectory* Indexed = IndexedTrajectories.Find(Component);
+	if (Indexed == nullptr) return;
+
+	TArray<FRGTrajectoryIndexHit> IndexHits;
+	TrajectoryIndex.QueryOwner(Indexed->Owner, Radius, IndexTime, IndexTime + WithinSeconds, IndexHits);
+	ConvertIndexHits(IndexHits, OutHits);
+}
+
+void URGTrajectorySubsystem::QueryTrajectoriesAlongRay(const FVector& Start, const FVector& End, float Radius,
+	float WithinSeconds, TArray<FRGTrajectoryQueryHit>& OutHits) const
+{
+	TArray<FRGTrajectoryIndexHit> IndexHits;
+	TrajectoryIndex.QueryRay(Start, End, Radius, IndexTime, IndexTime + WithinSeconds, IndexHits);
+	ConvertIndexHits(IndexHits, OutHits);
+}
+
+void URGTrajectorySubsystem::GatherAvoidancePairs(TConstArrayView<const URGTrajectoryMovementComponent*> Components,
+	float Radius, float WithinSeconds, TArray<FIntPoint>& OutPairs) const
+{
+	TMap<const URGTrajectoryMovementComponent*, int32> ComponentIndices;
+	ComponentIndices.Reserve(Components.Num());
+	for (int32 Idx = 0; Idx < Components.Num(); Idx++)
+	{
+		ComponentIndices.Add(Components[Idx], Idx);
+	}
+
+	TArray<FRGTrajectoryIndexHit> IndexHits;
+	for (int32 Idx = 0; Idx < Components.Num(); Idx++)
+	{
+		const FIndexedTrajectory* Indexed = IndexedTrajectories.Find(Components[Idx]);
+		if (Indexed == nullptr) continue;
+
+		IndexHits.Reset();
+		TrajectoryIndex.QueryOwner(Indexed->Owner, Radius, IndexTime, IndexTime + WithinSeconds, IndexHits);
+		for (const FRGTrajectoryIndexHit& Hit : IndexHits)
+		{
+			// Each pair is found from both ends; only keep it once.
+			const int32* Other = ComponentIndices.Find(IndexOwners[Hit.Owner]);
+			if (Other != nullptr && *Other > Idx)
+			{
+				OutPairs.Emplace(Idx, *Other);
+			}
+		}
+	}
+}
+
+void URGTrajectorySubsystem::DrawTrajectoryDebug()
+{
+#if ENABLE_DRAW_DEBUG || WITH_EDITORONLY_DATA
+	UWorld* World = GetWorld();
+	if (!IsValid(World) || !World->LineBatcher) return;
+
+	const bool bLocalPlayerOnly = CVarTrajectoryDebugLocalPlayerOnly.GetValueOnGameThread();
+	const int32 MaxPawns = CVarTrajectoryDebugMaxPawns.GetValueOnGameThread();
+	const int32 SampleStride = FMath::Max(CVarTrajectoryDebugSampleStride.GetValueOnGameThread(), 1);
+
+	FVector ViewLocation = FVector::ZeroVector;
+	if (const APlayerController* PlayerController = World->GetFirstPlayerController())
+	{
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	}
+
+	struct FDebugCandidate
+	{
+		URGTrajectoryMovementComponent* Component;
+		double DistanceSquared;
+	};
+
+	TArray<FDebugCandidate, TInlineAllocator<64>> Candidates;
+	for (URGTrajectoryMovementComponent* Component : TrajectoryComponents)
+	{
+		if (!IsValid(Component) || !Component->IsTrajectoryDebugEnabled()) continue;
+
+		const APawn* Pawn = Component->GetPawnOwner();
+		if (!IsValid(Pawn)) continue;
+		if (bLocalPlayerOnly && !(Pawn->IsPlayerControlled() && Pawn->IsLocallyControlled())) continue;
+
+		Candidates.Add({ Component, FVector::DistSquared(ViewLocation, Pawn->GetActorLocation()) });
+	}
+
+	if (MaxPawns > 0 && Candidates.Num() > MaxPawns)
+	{
+		Candidates.Sort([](const FDebugCandidate& A, const FDebugCandidate& B) { return A.DistanceSquared < B.DistanceSquared; });
+		Candidates.SetNum(MaxPawns, false);
+	}
+
+	DebugLines.Reset();
+	for (const FDebugCandidate& Candidate : Candidates)
+	{
+		Candidate.Component->AppendDebugLines(DebugLines, SampleStride);
+	}
+
+	if (!DebugLines.IsEmpty())
+	{
+		World->LineBatcher->DrawLines(DebugLines);
+	}
+#endif
+}
@@ -0,0 +1,177 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/LineBatchComponent.h"
+#include "RGRootMotionTable.h"
+#include "RGTrajectoryHistory.h"
+#include "RGTrajectorySpatialIndex.h"
+#include "UObject/ObjectKey.h"
+#include "RGTrajectorySubsystem.generated.h"
+
+class UAnimMontage;
+class URGTrajectoryMovementComponent;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogRGTrajectory, Log, All);
+
+/// A trajectory found by one of the subsystem's spatial queries.
+struct ROOICORE_API FRGTrajectoryQueryHit
+{
+	URGTrajectoryMovementComponent* Component { nullptr };
+
+	/// Seconds from now until the trajectory is closest.
+	float Seconds { 0.f };
+
+	/// Where the trajectory is at that point.
+	FVector Location { 0.f };
+
+	float Distance { 0.f };
+
+	/// For ray queries, how far along the ray the closest approach is; otherwise zero.
+	float RayDistance { 0.f };
+};
+
+/// World-level bookkeeping for every active trajectory component; anything which needs to look at all of
+/// them at once (such as debug rendering) lives here rather than on the individual components.
+UCLASS()
+class ROOICORE_API URGTrajectorySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterTrajectoryComponent(URGTrajectoryMovementComponent* Component);
+	void UnregisterTrajectoryComponent(URGTrajectoryMovementComponent* Component);
+
+	const TArray<TObjectPtr<URGTrajectoryMovementComponent>>& GetTrajectoryComponents() const { return TrajectoryComponents; }
+
+	/// Queue a component's pending ragdoll enable/disable. At most rg.Ragdoll.MaxTransitionsPerFrame queued
+	/// transitions are processed each frame, so that mass ragdolling is spread over several frames.
+	void QueueRagdollTransition(URGTrajectoryMovementComponent* Component);
+	void DequeueRagdollTransition(URGTrajectoryMovementComponent* Component);
+
+	/// History slots come in capacity classes, each twice the size of the last, starting from this many entries;
+	/// a component takes a slot from the smallest class its history fits in.
+	static constexpr int32 MinHistorySlotCapacity = 64;
+	static constexpr int32 NumHistorySlotClasses = 4;
+
+	/// Slots per arena page. Pages are allocated whole and never move, so handed-out slots stay valid.
+	static constexpr int32 HistorySlotsPerPage = 8;
+
+	/// The smallest slot class holding at least Capacity entries, or INDEX_NONE if even the largest is too small,
+	/// in which case the component has to keep its own storage.
+	static int32 GetHistorySlotClass(int32 Capacity);
+	static int32 GetHistorySlotCapacity(int32 SlotClass) { return MinHistorySlotCapacity << SlotClass; }
+
+	/// Hands out a free history slot of the given class, preferring the lowest so that live history stays
+	/// tightly packed.
+	int32 AcquireHistorySlot(int32 SlotClass);
+	void ReleaseHistorySlot(int32 SlotClass, int32 Slot);
+
+	/// The first of the slot's GetHistorySlotCapacity(SlotClass) entries.
+	FRGTrajectoryHistoryEntry* GetHistorySlotData(int32 SlotClass, int32 Slot) const;
+
+	/// Finds every pawn whose predicted trajectory passes within Radius of a point in the next WithinSeconds.
+	/// These queries use a grid over all predicted trajectories, brought up to date each frame for the ones that
+	/// changed, and only look at the part of it near what's being queried. Game thread only.
+	void QueryTrajectoriesNearPoint(const FVector& Point, float Radius, float WithinSeconds, TArray<FRGTrajectoryQueryHit>& OutHits) const;
+
+	/// Finds every pawn predicted to come within Radius of the given pawn, at the same moment, in the next
+	/// WithinSeconds.
+	void QueryTrajectoriesNearComponent(const URGTrajectoryMovementComponent* Component, float Radius, float WithinSeconds, TArray<FRGTrajectoryQueryHit>& OutHits) const;
+
+	/// Finds every pawn whose predicted trajectory passes within Radius of a line segment in the next
+	/// WithinSeconds, nearest the start of the segment first.
+	void QueryTrajectoriesAlongRay(const FVector& Start, const FVector& End, float Radius, float WithinSeconds, TArray<FRGTrajectoryQueryHit>& OutHits) const;
+
+	/// Uses the spatial index to find which of the given components might come within Radius of each other in
+	/// the next WithinSeconds, as pairs of indices into Components; suitable as candidates for
+	/// FRGTrajectoryAvoidanceBatch::TestPairs, with the trajectories added in the same order.
+	void GatherAvoidancePairs(TConstArrayView<const URGTrajectoryMovementComponent*> Components, float Radius, float WithinSeconds, TArray<FIntPoint>& OutPairs) const;
+
+	/// The montage's root motion table, baked at rg.Trajectory.RootMotion.SampleRate the first time it's asked
+	/// for. Tables are shared by every component playing the montage and never change once baked, so trajectory
+	/// ticks may read them from any thread. Null if the montage has no root motion. Game thread only.
+	TSharedPtr<const FRGRootMotionTable> FindOrBakeRootMotionTable(const UAnimMontage* Montage);
+
+private:
+
+	void ProcessRagdollTransitions();
+
+	/// Re-indexes the predicted trajectory of every component whose prediction has changed since last time.
+	void UpdateTrajectoryIndex();
+
+	void ConvertIndexHits(const TArray<FRGTrajectoryIndexHit>& IndexHits, TArray<FRGTrajectoryQueryHit>& OutHits) const;
+
+	/// Gathers every debug-enabled component's lines into a single batch and submits it to the world's
+	/// line batcher, honoring the rg.Trajectory.Debug.* filters.
+	void DrawTrajectoryDebug();
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<URGTrajectoryMovementComponent>> TrajectoryComponents;
+
+	/// Components waiting on a ragdoll transition, oldest first.
+	TArray<TWeakObjectPtr<URGTrajectoryMovementComponent>> PendingRagdollTransitions;
+
+	/// The shared history arena for one slot class, in pages of HistorySlotsPerPage contiguous slots.
+	///
+	/// This is deliberately paged rather than one contiguous block per class: components hold raw pointers into
+	/// their slots, so a single block couldn't grow without either moving live history out from under them or
+	/// being sized for the worst case up front. Nothing walks the arena in one linear pass (each component reads
+	/// its own slot from its own tick), so the locality that matters is within a slot, and between neighbouring
+	/// slots in a page, both of which paging keeps.
+	struct FHistorySlotPool
+	{
+		TArray<TUniquePtr<FRGTrajectoryHistoryEntry[]>> Pages;
+
+		/// Free slots, kept as a min-heap.
+		TArray<int32> FreeSlots;
+	};
+
+	FHistorySlotPool HistorySlotPools[NumHistorySlotClasses];
+
+	struct FIndexedTrajectory
+	{
+		int32 Owner { INDEX_NONE };
+		uint32 Revision { 0 };
+	};
+
+	FRGTrajectorySpatialIndex TrajectoryIndex;
+
+	/// Each registered component's owner ID in the index, and the prediction revision last indexed.
+	TMap<const URGTrajectoryMovementComponent*, FIndexedTrajectory> IndexedTrajectories;
+
+	/// Components by owner ID; unused IDs are null, and listed in FreeIndexOwners.
+	TArray<URGTrajectoryMovementComponent*> IndexOwners;
+	TArray<int32> FreeIndexOwners;
+
+	/// Reused between frames so that re-indexing doesn't reallocate.
+	TArray<FRGTrajectorySegment> IndexSegmentScratch;
+
+	/// World time the index was last brought up to date.
+	double IndexTime { 0.0 };
+
+	/// Baked root motion by montage. Montages without root motion map to null, so they're only looked at once.
+	TMap<TObjectKey<UAnimMontage>, TSharedPtr<const FRGRootMotionTable>> RootMotionTables;
+
+#if ENABLE_DRAW_DEBUG || WITH_EDITORONLY_DATA
+	/// Reused between frames so that debug rendering doesn't reallocate.
+	TArray<FBatchedLine> DebugLines;
+#endif
+
+};
@@ -0,0 +1,170 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+// Microbenchmark for the engine-independent trajectory core; see CMakeLists.txt alongside. Only built
+// standalone, so it compiles to nothing as part of the plugin.
+#if defined(RG_TRAJECTORY_CORE_STANDALONE)
+
+#include "RGTrajectoryCore.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace RGTrajectoryCore;
+
+namespace
+{
+	/// Keeps the optimizer from discarding results.
+	volatile double Sink = 0.0;
+
+	template <typename FunctionType>
+	void Run(const char* Name, int32_t Iterations, FunctionType&& Function)
+	{
+		// Warm up, then time.
+		Function(Iterations / 10 + 1);
+
+		const auto Start = std::chrono::steady_clock::now();
+		Function(Iterations);
+		const auto End = std::chrono::steady_clock::now();
+
+		const double Nanoseconds = std::chrono::duration<double, std::nano>(End - Start).count();
+		std::printf("%-40s %10.1f ns/op\n", Name, Nanoseconds / Iterations);
+	}
+
+	FTrajectoryModelInput MakeInput(std::mt19937& Random, ERGTrajectoryModelType Type)
+	{
+		std::uniform_real_distribution<double> Unit(-1.0, 1.0);
+
+		FTrajectoryModelInput Input;
+		Input.Type = Type;
+		Input.Location = FVec3(Unit(Random) * 10000.0, Unit(Random) * 10000.0, 0.0);
+		Input.Velocity = FVec3(Unit(Random) * 600.0, Unit(Random) * 600.0, Type == ERGTrajectoryModelType::Ballistic ? 400.0 : 0.0);
+		Input.Acceleration = FVec3(Unit(Random) * 2048.0, Unit(Random) * 2048.0, 0.0);
+		Input.YawRate = Unit(Random) * 180.0;
+		Input.YawRateDecay = 2.859;
+		Input.BrakingDeceleration = 2048.0;
+		Input.Friction = 8.0;
+		Input.MaxSpeed = 600.0;
+		Input.AirControl = 0.05;
+		Input.bHasLandingHeight = true;
+		Input.LandingHeight = -100.0;
+		Input.Drag = 2.0;
+		return Input;
+	}
+}
+
+int main()
+{
+	constexpr int32_t NumInputs = 1024;
+	constexpr int32_t SamplesPerPrediction = 30;
+	constexpr double TimePerSample = 1.0 / 30.0;
+
+	std::mt19937 Random(1234);
+	std::vector<FTrajectoryModelInput> Grounded;
+	std::vector<FTrajectoryModelInput> Braking;
+	std::vector<FTrajectoryModelInput> Ballistic;
+	for (int32_t Idx = 0; Idx < NumInputs; Idx++)
+	{
+		Grounded.push_back(MakeInput(Random, ERGTrajectoryModelType::Grounded));
+		Braking.push_back(Grounded.back());
+		Braking.back().Acceleration = FVec3();
+		Ballistic.push_back(MakeInput(Random, ERGTrajectoryModelType::Ballistic));
+	}
+
+	auto Predict = [&](const std::vector<FTrajectoryModelInput>& Inputs)
+	{
+		return [&Inputs](int32_t Iterations)
+		{
+			FTrajectoryModel Model;
+			FVec3 Location;
+			FVec3 Velocity;
+			double YawDelta;
+			double Total = 0.0;
+			for (int32_t Iteration = 0; Iteration < Iterations; Iteration++)
+			{
+				Model.Initialize(Inputs[Iteration % NumInputs]);
+				for (int32_t Sample = 1; Sample <= SamplesPerPrediction; Sample++)
+				{
+					Model.Evaluate(TimePerSample * Sample, Location, Velocity, YawDelta);
+					Total += Location.X;
+				}
+			}
+			Sink = Total;
+		};
+	};
+
+	std::printf("Per prediction of %d samples:\n", SamplesPerPrediction);
+	Run("Grounded (accelerating, turning)", 200000, Predict(Grounded));
+	Run("Grounded (braking)", 200000, Predict(Braking));
+	Run("Ballistic", 200000, Predict(Ballistic));
+
+	Run("Path speed profile", 200000, [&](int32_t Iterations)
+	{
+		FPathSpeedProfile Profile;
+		double Distance;
+		double Speed;
+		double Total = 0.0;
+		for (int32_t Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			const FTrajectoryModelInput& Input = Grounded[Iteration % NumInputs];
+			Profile.Initialize(Input.Velocity.XY().Size(), Input.Acceleration.XY().Size(), Input.MaxSpeed, Input.BrakingDeceleration,
+				Input.Friction, std::abs(Input.Location.X) * 0.1);
+			for (int32_t Sample = 1; Sample <= SamplesPerPrediction; Sample++)
+			{
+				Profile.Evaluate(TimePerSample * Sample, Distance, Speed);
+				Total += Distance;
+			}
+		}
+		Sink = Total;
+	});
+
+	std::printf("Per call:\n");
+	Run("AngleDifferenceXY", 5000000, [&](int32_t Iterations)
+	{
+		double Total = 0.0;
+		for (int32_t Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			const FTrajectoryModelInput& Input = Grounded[Iteration % NumInputs];
+			Total += AngleDifferenceXY(Input.Velocity, Input.Acceleration);
+		}
+		Sink = Total;
+	});
+
+	Run("GroundedStopOffset", 5000000, [&](int32_t Iterations)
+	{
+		double Total = 0.0;
+		for (int32_t Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			const FTrajectoryModelInput& Input = Grounded[Iteration % NumInputs];
+			Total += GroundedStopOffset(Input.Velocity, Input.BrakingDeceleration, Input.Friction).X;
+		}
+		Sink = Total;
+	});
+
+	Run("GroundedPivotOffset", 5000000, [&](int32_t Iterations)
+	{
+		double Total = 0.0;
+		for (int32_t Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			const FTrajectoryModelInput& Input = Grounded[Iteration % NumInputs];
+			Total += GroundedPivotOffset(Input.Acceleration, Input.Velocity, Input.Friction).X;
+		}
+		Sink = Total;
+	});
+
+	return 0;
+}
+
+#endif
@@ -0,0 +1,350 @@
+/* ROOIBOT CORE FRAMEWORK
+ * Copyright 2023, Rooibot Games, LLC. - All rights reserved.
+ *
+ * The URGTrajectoryMovementComponent and support files have been made
+ * available for the use of other licensees of GRIMTEC's Unreal Engine 5
+ * plugin "General Movement Component v2". They may be redistributed to
+ * other GMCv2 licensees, provided this notice remains intact.
+ *
+ * Questions can be addressed to Rachel Blackman at either
+ * rachel.blackman@rooibot.com or as "Packetdancer" on Discord.
+ */
+
+
+// Unit tests for the engine-independent trajectory core; see CMakeLists.txt alongside. Only built standalone,
+// so it compiles to nothing as part of the plugin.
+#if defined(RG_TRAJECTORY_CORE_STANDALONE)
+
+#include "RGTrajectoryCore.h"
+
+#include <cstdio>
+
+using namespace RGTrajectoryCore;
+
+namespace
+{
+	int32_t NumFailures = 0;
+
+	void Check(bool bCondition, const char* Name)
+	{
+		if (!bCondition)
+		{
+			std::printf("FAILED: %s\n", Name);
+			NumFailures++;
+		}
+	}
+
+	void CheckNear(double Actual, double Expected, double Tolerance, const char* Name)
+	{
+		if (!(std::abs(Actual - Expected) <= Tolerance))
+		{
+			std::printf("FAILED: %s (got %f, expected %f +/- %f)\n", Name, Actual, Expected, Tolerance);
+			NumFailures++;
+		}
+	}
+
+	void CheckNear(const FVec3& Actual, const FVec3& Expected, double Tolerance, const char* Name)
+	{
+		if (!((Actual - Expected).Size() <= Tolerance))
+		{
+			std::printf("FAILED: %s (got %f %f %f, expected %f %f %f +/- %f)\n", Name, Actual.X, Actual.Y, Actual.Z,
+				Expected.X, Expected.Y, Expected.Z, Tolerance);
+			NumFailures++;
+		}
+	}
+
+	/// Fine time step for the stepped reference integrations the closed-form models are checked against.
+	constexpr double ReferenceTimeStep = 1.0 / 10000.0;
+
+	void TestStopAndPivot()
+	{
+		double Seconds;
+
+		// Braking under friction: deceleration is BrakingDeceleration * Friction = 16384, so from 600 we stop in
+		// 600 / 16384 seconds, after 600^2 / (2 * 16384) units.
+		const FVec3 Stop = GroundedStopOffset(FVec3(600.0, 0.0, 0.0), 2048.0, 8.0, &Seconds);
+		CheckNear(Stop, FVec3(360000.0 / 32768.0, 0.0, 0.0), 1.e-9, "GroundedStopOffset distance");
+		CheckNear(Seconds, 600.0 / 16384.0, 1.e-12, "GroundedStopOffset time");
+
+		// Only horizontal velocity brakes.
+		CheckNear(GroundedStopOffset(FVec3(0.0, 300.0, 1000.0), 1000.0, 1.0), FVec3(0.0, 45.0, 0.0), 1.e-9, "GroundedStopOffset ignores Z");
+
+		CheckNear(GroundedStopOffset(FVec3(600.0, 0.0, 0.0), 0.0, 8.0, &Seconds), FVec3(), 0.0, "GroundedStopOffset without brakes");
+		CheckNear(Seconds, 0.0, 0.0, "GroundedStopOffset without brakes time");
+
+		// Reversing from 600 against 2048 with friction 8: the combined deceleration is 2048 + 2 * 600 * 8 = 11648,
+		// so the turnaround takes 600 / 11648 seconds and covers 600^2 / (2 * 11648) units.
+		const FVec3 Pivot = GroundedPivotOffset(FVec3(-2048.0, 0.0, 0.0), FVec3(600.0, 0.0, 0.0), 8.0, &Seconds);
+		CheckNear(Pivot, FVec3(360000.0 / 23296.0, 0.0, 0.0), 1.e-9, "GroundedPivotOffset distance");
+		CheckNear(Seconds, 600.0 / 11648.0, 1.e-12, "GroundedPivotOffset time");
+
+		// No pivot unless accelerating against our velocity.
+		CheckNear(GroundedPivotOffset(FVec3(2048.0, 0.0, 0.0), FVec3(600.0, 0.0, 0.0), 8.0, &Seconds), FVec3(), 0.0, "GroundedPivotOffset with velocity");
+		CheckNear(Seconds, 0.0, 0.0, "GroundedPivotOffset with velocity time");
+		CheckNear(GroundedPivotOffset(FVec3(0.0, 2048.0, 0.0), FVec3(600.0, 0.0, 0.0), 8.0), FVec3(), 0.0, "GroundedPivotOffset across velocity");
+	}
+
+	void TestAngles()
+	{
+		CheckNear(AngleDifferenceXY(FVec3(1.0, 0.0, 0.0), FVec3(0.0, 1.0, 0.0)), 90.0, 1.e-9, "AngleDifferenceXY left");
+		CheckNear(AngleDifferenceXY(FVec3(1.0, 0.0, 0.0), FVec3(0.0, -1.0, 0.0)), -90.0, 1.e-9, "AngleDifferenceXY right");
+		CheckNear(AngleDifferenceXY(FVec3(3.0, 3.0, 0.0), FVec3(1.0, 1.0, 0.0)), 0.0, 1.e-9, "AngleDifferenceXY same direction");
+
+		// Either side of straight behind wraps from +180 to -180.
+		const double JustShortOfBehind = 180.0 - std::atan(0.01) * 180.0 / Pi;
+		CheckNear(AngleDifferenceXY(FVec3(1.0, 0.0, 0.0), FVec3(-1.0, 0.01, 0.0)), JustShortOfBehind, 1.e-9, "AngleDifferenceXY behind left");
+		CheckNear(AngleDifferenceXY(FVec3(1.0, 0.0, 0.0), FVec3(-1.0, -0.01, 0.0)), -JustShortOfBehind, 1.e-9, "AngleDifferenceXY behind right");
+		CheckNear(std::abs(AngleDifferenceXY(FVec3(1.0, 0.0, 0.0), FVec3(-1.0, 0.0, 0.0))), 180.0, 1.e-9, "AngleDifferenceXY opposite");
+
+		// Only yaw counts.
+		CheckNear(AngleDifferenceXY(FVec3(1.0, 0.0, 5.0), FVec3(0.0, 1.0, -5.0)), 90.0, 1.e-9, "AngleDifferenceXY ignores Z");
+
+		CheckNear(AngleDifferenceZ(FVec3(1.0, 0.0, 1.0), FVec3(0.0, 1.0, 2.0)), 0.0, 1.e-9, "AngleDifferenceZ same direction");
+		CheckNear(std::abs(AngleDifferenceZ(FVec3(0.0, 0.0, 1.0), FVec3(0.0, 0.0, -1.0))), 180.0, 1.e-9, "AngleDifferenceZ opposite");
+	}
+
+	void TestHistory()
+	{
+		Check(ShouldCullHistorySample(-1.1, 1.0, 0.0), "ShouldCullHistorySample too old");
+		Check(!ShouldCullHistorySample(-0.5, 1.0, 0.0), "ShouldCullHistorySample recent");
+		Check(ShouldCullHistorySample(-0.5, 1.0, -0.4), "ShouldCullHistorySample before horizon");
+		Check(!ShouldCullHistorySample(-0.3, 1.0, -0.4), "ShouldCullHistorySample after horizon");
+
+		CheckNear(UpdateHistoryTimeDomain(0.0, true, -0.5), -0.5, 0.0, "UpdateHistoryTimeDomain pins on stop");
+		CheckNear(UpdateHistoryTimeDomain(-0.5, true, -0.2), -0.5, 0.0, "UpdateHistoryTimeDomain holds while stopped");
+		CheckNear(UpdateHistoryTimeDomain(-0.5, false, -0.2), 0.0, 0.0, "UpdateHistoryTimeDomain clears when moving");
+	}
+
+	/// Checks a model against a stepped reference at a handful of times. Step advances the reference state by
+	/// ReferenceTimeStep.
+	template <typename StepFunction>
+	void CheckModelAgainstReference(const FTrajectoryModelInput& Input, double Duration, double Tolerance, const char* Name, StepFunction&& Step)
+	{
+		FTrajectoryModel Model;
+		Model.Initialize(Input);
+
+		FVec3 Location = Input.Location;
+		FVec3 Velocity = Input.Velocity;
+		const int32_t NumSteps = static_cast<int32_t>(Duration / ReferenceTimeStep + 0.5);
+		for (int32_t StepIdx = 1; StepIdx <= NumSteps; StepIdx++)
+		{
+			Step(Location, Velocity);
+
+			if (StepIdx % (NumSteps / 8) == 0)
+			{
+				FVec3 ModelLocation;
+				FVec3 ModelVelocity;
+				double YawDelta;
+				Model.Evaluate(StepIdx * ReferenceTimeStep, ModelLocation, ModelVelocity, YawDelta);
+
+				char Label[128];
+				std::snprintf(Label, sizeof(Label), "%s location at %.3fs", Name, StepIdx * ReferenceTimeStep);
+				CheckNear(ModelLocation, Location, Tolerance, Label);
+			}
+		}
+	}
+
+	/// The stepped prediction the grounded model replaced: friction steers velocity towards the acceleration
+	/// direction, acceleration is added on top, and speed is clamped to MaxSpeed.
+	void CheckAgainstSteppedPrediction(const FTrajectoryModelInput& Input, const char* Name)
+	{
+		CheckModelAgainstReference(Input, 1.0, 0.1, Name, [&](FVec3& Location, FVec3& Velocity)
+		{
+			const FVec3 Direction = Input.Acceleration.GetSafeNormal();
+			Velocity = Velocity - (Velocity - Direction * Velocity.Size()) * (Input.Friction * ReferenceTimeStep);
+			Velocity = (Velocity + Input.Acceleration * ReferenceTimeStep).GetClampedToMaxSize(Input.MaxSpeed);
+			Location = Location + Velocity * ReferenceTimeStep;
+		});
+	}
+
+	/// The grounded model's own dynamics, stepped: along the (turning) heading, speed changes at the acceleration
+	/// until it reaches MaxSpeed, and across it speed decays under friction.
+	void CheckAgainstSteppedHeading(const FTrajectoryModelInput& Input, double Tolerance, const char* Name)
+	{
+		double Heading = std::atan2(Input.Acceleration.Y, Input.Acceleration.X);
+		const FVec2 Frame = FVec2::ExpI(Heading);
+		double AlongSpeed = Input.Velocity.XY().Dot(Frame);
+		double LateralSpeed = Input.Velocity.XY().Dot(FVec2 { -Frame.Y, Frame.X });
+		double TurnRate = Input.YawRate * Pi / 180.0;
+		const double AccelerationSize = Input.Acceleration.XY().Size();
+
+		CheckModelAgainstReference(Input, 1.0, Tolerance, Name, [&](FVec3& Location, FVec3& Velocity)
+		{
+			AlongSpeed = AlongSpeed < Input.MaxSpeed ?
+				std::min(AlongSpeed + AccelerationSize * ReferenceTimeStep, Input.MaxSpeed) :
+				std::max(AlongSpeed - AccelerationSize * ReferenceTimeStep, Input.MaxSpeed);
+			LateralSpeed -= Input.Friction * LateralSpeed * ReferenceTimeStep;
+			Heading += TurnRate * ReferenceTimeStep;
+			TurnRate *= std::exp(-Input.YawRateDecay * ReferenceTimeStep);
+
+			Velocity = FVec3(FVec2::ExpI(Heading).ComplexMul(FVec2 { AlongSpeed, LateralSpeed }), 0.0);
+			Location = Location + Velocity * ReferenceTimeStep;
+		});
+	}
+
+	void TestModels()
+	{
+		FTrajectoryModelInput Grounded;
+		Grounded.Location = FVec3(100.0, 200.0, 0.0);
+		Grounded.Acceleration = FVec3(2048.0, 0.0, 0.0);
+		Grounded.Friction = 8.0;
+		Grounded.MaxSpeed = 600.0;
+
+		// In a straight line, the model should agree with the stepped prediction it replaced.
+		CheckAgainstSteppedPrediction(Grounded, "Grounded accelerating from rest");
+		{
+			FTrajectoryModelInput Moving = Grounded;
+			Moving.Velocity = FVec3(300.0, 0.0, 0.0);
+			CheckAgainstSteppedPrediction(Moving, "Grounded accelerating at speed");
+
+			FTrajectoryModelInput Frictionless = Grounded;
+			Frictionless.Friction = 0.0;
+			CheckAgainstSteppedPrediction(Frictionless, "Grounded accelerating without friction");
+		}
+
+		// Moving across or faster than the acceleration, and turning.
+		{
+			FTrajectoryModelInput Lateral = Grounded;
+			Lateral.Velocity = FVec3(0.0, 300.0, 0.0);
+			CheckAgainstSteppedHeading(Lateral, 0.1, "Grounded accelerating across velocity");
+
+			FTrajectoryModelInput Fast = Grounded;
+			Fast.Velocity = FVec3(900.0, 100.0, 0.0);
+			CheckAgainstSteppedHeading(Fast, 0.1, "Grounded slowing to max speed");
+
+			FTrajectoryModelInput Turning = Grounded;
+			Turning.Velocity = FVec3(200.0, 50.0, 0.0);
+			Turning.Acceleration = FVec3(0.0, 2048.0, 0.0);
+			Turning.YawRate = -120.0;
+			CheckAgainstSteppedHeading(Turning, 0.1, "Grounded turning");
+
+			// A decaying turn is approximated by constant-rate segments, one per half-life.
+			FTrajectoryModelInput DecayingTurn = Grounded;
+			DecayingTurn.Velocity = FVec3(600.0, 0.0, 0.0);
+			DecayingTurn.YawRate = 90.0;
+			DecayingTurn.YawRateDecay = 2.859;
+			CheckAgainstSteppedHeading(DecayingTurn, 5.0, "Grounded decaying turn");
+		}
+
+		FTrajectoryModelInput Braking;
+		Braking.Location = FVec3(100.0, 200.0, 0.0);
+		Braking.Velocity = FVec3(480.0, 360.0, 0.0);
+		Braking.BrakingDeceleration = 2048.0;
+		Braking.Friction = 1.0;
+		CheckModelAgainstReference(Braking, 0.5, 0.5, "Grounded braking", [&](FVec3& Location, FVec3& Velocity)
+		{
+			// dv/dt = -Friction * v - BrakingDeceleration along v, until we stop.
+			const double Speed = Velocity.Size();
+			if (Speed <= 0.0) return;
+
+			const double NewSpeed = Speed - (Braking.Friction * Speed + Braking.BrakingDeceleration) * ReferenceTimeStep;
+			Velocity = NewSpeed > 0.0 ? Velocity * (NewSpeed / Speed) : FVec3();
+			Location = Location + Velocity * ReferenceTimeStep;
+		});
+
+		FTrajectoryModelInput Ballistic;
+		Ballistic.Type = ERGTrajectoryModelType::Ballistic;
+		Ballistic.Velocity = FVec3(300.0, 0.0, 400.0);
+		Ballistic.Acceleration = FVec3(0.0, 2048.0, 0.0);
+		Ballistic.AirControl = 0.05;
+		Ballistic.MaxSpeed = 600.0;
+		Ballistic.bHasLandingHeight = true;
+		Ballistic.LandingHeight = -100.0;
+		CheckModelAgainstReference(Ballistic, 1.6, 0.5, "Ballistic", [&](FVec3& Location, FVec3& Velocity)
+		{
+			// Constant acceleration, with vertical movement ending once we land.
+			const bool bLanded = Location.Z <= Ballistic.LandingHeight && Velocity.Z <= 0.0;
+			Velocity = Velocity + FVec3(Ballistic.Acceleration.XY() * Ballistic.AirControl, bLanded ? 0.0 : Ballistic.Gravity.Z) * ReferenceTimeStep;
+			if (bLanded)
+			{
+				Velocity.Z = 0.0;
+			}
+
+			const FVec3 NewLocation = Location + Velocity * ReferenceTimeStep;
+			Location = FVec3(NewLocation.XY(), std::max(NewLocation.Z, Ballistic.LandingHeight));
+		});
+
+		// Air control never takes horizontal speed past MaxSpeed.
+		{
+			FTrajectoryModelInput Capped = Ballistic;
+			Capped.MaxSpeed = 350.0;
+			Capped.bHasLandingHeight = false;
+
+			FTrajectoryModel Model;
+			Model.Initialize(Capped);
+
+			FVec3 Location;
+			FVec3 Velocity;
+			double YawDelta;
+			Model.Evaluate(3.0, Location, Velocity, YawDelta);
+			CheckNear(Velocity.XY().Size(), Capped.MaxSpeed, 1.e-6, "Ballistic horizontal speed cap");
+		}
+
+		FTrajectoryModelInput Drag;
+		Drag.Type = ERGTrajectoryModelType::Drag;
+		Drag.Velocity = FVec3(500.0, 0.0, -100.0);
+		Drag.Acceleration = FVec3(0.0, 400.0, 0.0);
+		Drag.Drag = 2.0;
+		Drag.MaxSpeed = 1000.0;
+		CheckModelAgainstReference(Drag, 1.0, 0.5, "Drag", [&](FVec3& Location, FVec3& Velocity)
+		{
+			// dv/dt = Acceleration - Drag * v
+			Velocity = Velocity + (Drag.Acceleration - Velocity * Drag.Drag) * ReferenceTimeStep;
+			Location = Location + Velocity * ReferenceTimeStep;
+		});
+	}
+
+	void TestPathSpeedProfile(double StartSpeed, double PathLength, const char* Name)
+	{
+		FPathSpeedProfile Profile;
+		Profile.Initialize(StartSpeed, 2048.0, 600.0, 2048.0, 8.0, PathLength);
+
+		char Label[128];
+		std::snprintf(Label, sizeof(Label), "%s stops", Name);
+		Check(Profile.GetStopTime() >= 0.0, Label);
+
+		// We should arrive at the end of the path exactly as we stop, neither short of it nor clamped to it early.
+		double Distance;
+		double Speed;
+		Profile.Evaluate(Profile.GetStopTime(), Distance, Speed);
+		std::snprintf(Label, sizeof(Label), "%s distance at stop", Name);
+		CheckNear(Distance, PathLength, 1.e-3, Label);
+		std::snprintf(Label, sizeof(Label), "%s speed at stop", Name);
+		CheckNear(Speed, 0.0, 1.e-3, Label);
+
+		double PreviousDistance = 0.0;
+		for (int32_t Idx = 1; Idx < 100; Idx++)
+		{
+			Profile.Evaluate(Profile.GetStopTime() * Idx / 100.0, Distance, Speed);
+			if (Distance < PreviousDistance || Distance >= PathLength || Speed <= 0.0)
+			{
+				std::snprintf(Label, sizeof(Label), "%s progress before stop (%d%%)", Name, Idx);
+				Check(false, Label);
+				break;
+			}
+			PreviousDistance = Distance;
+		}
+	}
+}
+
+int main()
+{
+	TestStopAndPivot();
+	TestAngles();
+	TestHistory();
+	TestModels();
+	TestPathSpeedProfile(0.0, 500.0, "Path profile from rest");
+	TestPathSpeedProfile(300.0, 2000.0, "Path profile at speed");
+	TestPathSpeedProfile(0.0, 20.0, "Path profile on a short path");
+
+	if (NumFailures > 0)
+	{
+		std::printf("%d check(s) failed\n", NumFailures);
+		return 1;
+	}
+
+	std::printf("All checks passed\n");
+	return 0;
+}
+
+#endif